@@ -0,0 +1,542 @@
+#include "AVL_tree.hpp"
+#include "AVL_frozen.hpp"
+#include "AVL_lazy.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Benchmark of the AVL tree against std::set and a sorted vector.
+ *
+ * Every (structure, operation, workload) row is measured twice: one pass
+ * times each operation to get p50/p99/p999 latencies, a second pass without
+ * per-operation clocks gives the throughput. Results are printed as a table
+ * and written as CSV; --compare checks them against a previous CSV.
+ *
+ *   bench [--size N] [--repeats R] [--seed S] [--output FILE]
+ *         [--compare FILE] [--tolerance T]
+ */
+
+typedef chrono::steady_clock bench_clock;
+
+struct bench_options {
+  int         size;
+  int         repeats;
+  unsigned    seed;
+  string      output;
+  string      compare;
+  double      tolerance;
+};
+
+struct bench_result {
+  string structure;
+  string operation;
+  string workload;
+  int    size;
+  long   ops;
+  double p50_ns;
+  double p99_ns;
+  double p999_ns;
+  double mean_ns;
+  double ops_per_sec;
+};
+
+// Keeps results alive so the compiler cannot drop the measured work.
+static volatile float bench_sink;
+
+static double elapsed_ns(
+  bench_clock::time_point start,
+  bench_clock::time_point stop){
+    return static_cast<double>(
+      chrono::duration_cast<chrono::nanoseconds>(stop-start).count());
+}
+
+// Nearest-rank percentile of sorted samples.
+static double percentile(
+  const vector<double> &sorted,
+  double                fraction){
+    size_t rank=static_cast<size_t>(ceil(fraction*sorted.size()));
+    return sorted[rank>0 ? rank-1 : 0];
+}
+
+// Runs ops operations twice, once per-operation timed and once as a whole.
+// setup and teardown run outside the clock around each pass.
+template <typename Setup, typename Operation, typename Teardown>
+static struct bench_result measure(
+  const char  *structure,
+  const char  *operation,
+  const char  *workload,
+  int          size,
+  long         ops,
+  Setup        setup,
+  Operation    run,
+  Teardown     teardown){
+
+    vector<double> samples(ops);
+    setup();
+    for (long index = 0; index < ops; index++){
+      bench_clock::time_point start=bench_clock::now();
+      run(index);
+      samples[index]=elapsed_ns(start,bench_clock::now());
+    }
+    teardown();
+
+    setup();
+    bench_clock::time_point start=bench_clock::now();
+    for (long index = 0; index < ops; index++){
+      run(index);
+    }
+    double total=elapsed_ns(start,bench_clock::now());
+    teardown();
+
+    struct bench_result result;
+    result.structure=structure;
+    result.operation=operation;
+    result.workload=workload;
+    result.size=size;
+    result.ops=ops;
+    double sum=0;
+    for (long index = 0; index < ops; index++){
+      sum+=samples[index];
+    }
+    sort(samples.begin(),samples.end());
+    result.p50_ns=percentile(samples,0.50);
+    result.p99_ns=percentile(samples,0.99);
+    result.p999_ns=percentile(samples,0.999);
+    result.mean_ns=sum/ops;
+    result.ops_per_sec=total>0 ? ops*1e9/total : 0;
+    return result;
+}
+
+// Values are integers below 2^24, so every float is exact.
+static vector<float> make_workload(
+  const string &name,
+  int           size,
+  unsigned      seed){
+
+    mt19937 generator(seed);
+    const int limit=1<<24;
+    vector<float> keys(size);
+    if (name=="uniform"){
+      uniform_int_distribution<int> value(0,limit-1);
+      for (int index = 0; index < size; index++){
+        keys[index]=static_cast<float>(value(generator));
+      }
+    }
+    else if (name=="sorted" || name=="reverse"){
+      for (int index = 0; index < size; index++){
+        keys[index]=static_cast<float>(name=="sorted" ? index : size-1-index);
+      }
+    }
+    else if (name=="clustered"){
+      // Dense runs around a few random centers.
+      uniform_int_distribution<int> center(4096,limit-4096);
+      vector<int> centers(16);
+      for (size_t index = 0; index < centers.size(); index++){
+        centers[index]=center(generator);
+      }
+      uniform_int_distribution<int> pick(0,static_cast<int>(centers.size())-1);
+      normal_distribution<double> offset(0,size/64.0+1);
+      for (int index = 0; index < size; index++){
+        double value=centers[pick(generator)]+offset(generator);
+        keys[index]=static_cast<float>(max(0L,min(static_cast<long>(limit-1),lround(value))));
+      }
+    }
+    else {
+      // About 50 copies of each value.
+      uniform_int_distribution<int> value(0,size/50);
+      for (int index = 0; index < size; index++){
+        keys[index]=static_cast<float>(value(generator));
+      }
+    }
+    return keys;
+}
+
+// Sums the values visited by avl_traverse.
+static int sum_visit(
+  struct avl_node *node,
+  void            *context){
+    *static_cast<float *>(context)+=node->value;
+    return AVL_SUCCESS;
+}
+
+// Uniform interface over the measured structures.
+struct avl_subject {
+  static const char *name(){ return "avl"; }
+  struct avl_node *root;
+  avl_subject() : root(nullptr) {}
+  void insert(float value){ avl_node_add(value,&root); }
+  void remove(float value){ avl_node_remove(value,&root); }
+  bool search(float value){
+    struct avl_node *found_node;
+    return avl_search(value,&root,&found_node)==AVL_SUCCESS;
+  }
+  float min_value(){
+    struct avl_node *found_node;
+    avl_min_get(root,&found_node);
+    return found_node->value;
+  }
+  float max_value(){
+    struct avl_node *found_node;
+    avl_max_get(root,&found_node);
+    return found_node->value;
+  }
+  void build(const vector<float> &keys){
+    vector<float> copy(keys);
+    avl_bulk_create(copy.data(),static_cast<int>(copy.size()),&root);
+  }
+  float traverse(){
+    float sum=0;
+    avl_traverse(root,AVL_IN_ORDER,sum_visit,&sum);
+    return sum;
+  }
+  void clear(){ free_tree_mem(root); root=nullptr; }
+};
+
+struct set_subject {
+  static const char *name(){ return "std_set"; }
+  set<float> values;
+  void insert(float value){ values.insert(value); }
+  void remove(float value){ values.erase(value); }
+  bool search(float value){ return values.find(value)!=values.end(); }
+  float min_value(){ return *values.begin(); }
+  float max_value(){ return *values.rbegin(); }
+  void build(const vector<float> &keys){ values.insert(keys.begin(),keys.end()); }
+  float traverse(){
+    float sum=0;
+    for (set<float>::const_iterator it = values.begin(); it != values.end(); ++it){
+      sum+=*it;
+    }
+    return sum;
+  }
+  void clear(){ values.clear(); }
+};
+
+struct vector_subject {
+  static const char *name(){ return "sorted_vector"; }
+  vector<float> values;
+  void insert(float value){
+    vector<float>::iterator it=lower_bound(values.begin(),values.end(),value);
+    if (it==values.end() || *it!=value){
+      values.insert(it,value);
+    }
+  }
+  void remove(float value){
+    vector<float>::iterator it=lower_bound(values.begin(),values.end(),value);
+    if (it!=values.end() && *it==value){
+      values.erase(it);
+    }
+  }
+  bool search(float value){ return binary_search(values.begin(),values.end(),value); }
+  float min_value(){ return values.front(); }
+  float max_value(){ return values.back(); }
+  void build(const vector<float> &keys){
+    values=keys;
+    sort(values.begin(),values.end());
+    values.erase(unique(values.begin(),values.end()),values.end());
+  }
+  float traverse(){
+    float sum=0;
+    for (size_t index = 0; index < values.size(); index++){
+      sum+=values[index];
+    }
+    return sum;
+  }
+  void clear(){ values.clear(); values.shrink_to_fit(); }
+};
+
+// All operations of one structure on one workload. keys is the insertion
+// order, probes the distinct keys in random order.
+template <typename Subject>
+static void run_subject(
+  const char                 *workload,
+  const vector<float>        &keys,
+  const vector<float>        &probes,
+  const struct bench_options &options,
+  vector<struct bench_result> &results){
+
+    const char *name=Subject::name();
+    int size=static_cast<int>(keys.size());
+    Subject subject;
+    auto fill=[&subject,&keys](){ subject.build(keys); };
+    auto clear=[&subject](){ subject.clear(); };
+    auto nothing=[](){};
+
+    results.push_back(measure(name,"insert",workload,size,size,nothing,
+      [&subject,&keys](long index){ subject.insert(keys[index]); },clear));
+    results.push_back(measure(name,"remove",workload,size,probes.size(),fill,
+      [&subject,&probes](long index){ subject.remove(probes[index]); },clear));
+    results.push_back(measure(name,"search",workload,size,probes.size(),fill,
+      [&subject,&probes](long index){ bench_sink=subject.search(probes[index]); },clear));
+    results.push_back(measure(name,"min",workload,size,probes.size(),fill,
+      [&subject](long){ bench_sink=subject.min_value(); },clear));
+    results.push_back(measure(name,"max",workload,size,probes.size(),fill,
+      [&subject](long){ bench_sink=subject.max_value(); },clear));
+
+    // Whole-structure operations, repeated for the percentiles.
+    vector<Subject> built(options.repeats);
+    results.push_back(measure(name,"build",workload,size,options.repeats,nothing,
+      [&built,&keys](long index){ built[index].build(keys); },
+      [&built](){
+        for (size_t index = 0; index < built.size(); index++){
+          built[index].clear();
+        }
+      }));
+    results.push_back(measure(name,"traverse",workload,size,options.repeats,fill,
+      [&subject](long){ bench_sink=subject.traverse(); },clear));
+}
+
+// Inserts that pass the previously inserted node as hint, comparable with
+// the avl insert row.
+static void run_hinted(
+  const char                 *workload,
+  const vector<float>        &keys,
+  vector<struct bench_result> &results){
+
+    struct avl_node *root=nullptr;
+    struct avl_node *hint=nullptr;
+    results.push_back(measure("avl_hint","insert",workload,static_cast<int>(keys.size()),
+      keys.size(),[](){},
+      [&root,&hint,&keys](long index){ avl_hint_add(keys[index],&root,&hint); },
+      [&root,&hint](){ free_tree_mem(root); root=nullptr; hint=nullptr; }));
+}
+
+// Multiset inserts, where a repeated value only counts, and count lookups,
+// comparable with the avl insert and search rows.
+static void run_multi(
+  const char                 *workload,
+  const vector<float>        &keys,
+  const vector<float>        &probes,
+  vector<struct bench_result> &results){
+
+    struct avl_node *root=nullptr;
+    int count;
+    results.push_back(measure("avl_multi","insert",workload,static_cast<int>(keys.size()),
+      keys.size(),[](){},
+      [&root,&keys](long index){ avl_multi_add(keys[index],&root); },
+      [&root](){ free_tree_mem(root); root=nullptr; }));
+    results.push_back(measure("avl_multi","search",workload,static_cast<int>(keys.size()),
+      probes.size(),
+      [&root,&keys](){
+        for (size_t index = 0; index < keys.size(); index++){
+          avl_multi_add(keys[index],&root);
+        }
+      },
+      [&root,&probes,&count](long index){
+        avl_multi_count(root,probes[index],&count);
+        bench_sink=static_cast<float>(count);
+      },
+      [&root](){ free_tree_mem(root); root=nullptr; }));
+}
+
+// Removes that only mark nodes, comparable with the avl remove row.
+static void run_lazy(
+  const char                 *workload,
+  const vector<float>        &keys,
+  const vector<float>        &probes,
+  vector<struct bench_result> &results){
+
+    struct avl_lazy_tree tree;
+    avl_lazy_init(&tree,AVL_LAZY_DEFAULT_RATIO);
+    results.push_back(measure("avl_lazy","remove",workload,static_cast<int>(keys.size()),
+      probes.size(),
+      [&tree,&keys](){
+        for (size_t index = 0; index < keys.size(); index++){
+          avl_lazy_add(keys[index],&tree);
+        }
+      },
+      [&tree,&probes](long index){ avl_lazy_remove(probes[index],&tree); },
+      [&tree](){ avl_lazy_free(&tree); }));
+}
+
+// Lookups on a frozen copy, comparable with the avl search row.
+static void run_frozen(
+  const char                 *workload,
+  const vector<float>        &keys,
+  const vector<float>        &probes,
+  vector<struct bench_result> &results){
+
+    struct avl_subject subject;
+    struct avl_frozen_tree frozen;
+    subject.build(keys);
+    avl_freeze(subject.root,&frozen);
+    subject.clear();
+
+    uint32_t found_index;
+    results.push_back(measure("avl_frozen","search",workload,static_cast<int>(keys.size()),
+      probes.size(),[](){},
+      [&frozen,&probes,&found_index](long index){
+        bench_sink=avl_frozen_search(probes[index],&frozen,&found_index);
+      },[](){}));
+    avl_frozen_free(&frozen);
+}
+
+static string result_key(
+  const struct bench_result &result){
+    return result.structure+","+result.operation+","+result.workload+","+
+           to_string(result.size);
+}
+
+static bool write_results(
+  const string                      &path,
+  const vector<struct bench_result> &results){
+    ofstream output(path.c_str());
+    output << "structure,operation,workload,size,ops,p50_ns,p99_ns,p999_ns,mean_ns,ops_per_sec\n";
+    for (size_t index = 0; index < results.size(); index++){
+      const struct bench_result &result=results[index];
+      output << result_key(result) << "," << result.ops << ","
+             << result.p50_ns << "," << result.p99_ns << "," << result.p999_ns << ","
+             << result.mean_ns << "," << static_cast<long>(result.ops_per_sec) << "\n";
+    }
+    return static_cast<bool>(output);
+}
+
+// Reports rows whose throughput dropped by more than the tolerance against
+// a previous CSV. Returns the number of regressions, or -1 if unreadable.
+static int compare_results(
+  const string                      &path,
+  double                             tolerance,
+  const vector<struct bench_result> &results){
+
+    ifstream input(path.c_str());
+    if (!input){
+      return -1;
+    }
+    map<string,double> baseline;
+    string line;
+    getline(input,line);
+    while (getline(input,line)){
+      // Key is the first four fields, throughput the last one.
+      size_t key_end=0;
+      for (int field = 0; field < 4 && key_end != string::npos; field++){
+        key_end=line.find(',',key_end+(field>0));
+      }
+      size_t last=line.rfind(',');
+      if (key_end==string::npos || last==string::npos){
+        continue;
+      }
+      baseline[line.substr(0,key_end)]=atof(line.c_str()+last+1);
+    }
+
+    int regressions=0;
+    for (size_t index = 0; index < results.size(); index++){
+      map<string,double>::const_iterator old=baseline.find(result_key(results[index]));
+      if (old!=baseline.end() && results[index].ops_per_sec<old->second*(1-tolerance)){
+        printf("REGRESSION %s: %.0f ops/s, was %.0f\n",old->first.c_str(),
+               results[index].ops_per_sec,old->second);
+        regressions++;
+      }
+    }
+    return regressions;
+}
+
+static int parse_options(
+  int                   argc,
+  char                **argv,
+  struct bench_options *options){
+
+    options->size=100000;
+    options->repeats=20;
+    options->seed=1;
+    options->output="bench.csv";
+    options->tolerance=0.10;
+    for (int index = 1; index < argc; index++){
+      if (index+1>=argc){
+        return AVL_INVALID_PARAM;
+      }
+      const char *value=argv[++index];
+      if (strcmp(argv[index-1],"--size")==0){
+        options->size=atoi(value);
+      }
+      else if (strcmp(argv[index-1],"--repeats")==0){
+        options->repeats=atoi(value);
+      }
+      else if (strcmp(argv[index-1],"--seed")==0){
+        options->seed=static_cast<unsigned>(strtoul(value,nullptr,10));
+      }
+      else if (strcmp(argv[index-1],"--output")==0){
+        options->output=value;
+      }
+      else if (strcmp(argv[index-1],"--compare")==0){
+        options->compare=value;
+      }
+      else if (strcmp(argv[index-1],"--tolerance")==0){
+        options->tolerance=atof(value);
+      }
+      else {
+        return AVL_INVALID_PARAM;
+      }
+    }
+    if (options->size<100 || options->repeats<1){
+      return AVL_INVALID_PARAM;
+    }
+    return AVL_SUCCESS;
+}
+
+int main(int argc, char **argv){
+  struct bench_options options;
+  if (parse_options(argc,argv,&options)!=AVL_SUCCESS){
+    fprintf(stderr,"usage: %s [--size N>=100] [--repeats R>=1] [--seed S] "
+                   "[--output FILE] [--compare FILE] [--tolerance T]\n",argv[0]);
+    return 2;
+  }
+
+  const char *workloads[]={"uniform","sorted","reverse","clustered","duplicates"};
+  // Cost of the clocks alone, the floor of every per-operation latency. It
+  // has no throughput, so it never counts as a regression.
+  vector<struct bench_result> results;
+  results.push_back(measure("none","clock","none",0,options.size,[](){},
+    [](long){},[](){}));
+  results.back().ops_per_sec=0;
+  for (size_t index = 0; index < sizeof(workloads)/sizeof(workloads[0]); index++){
+    vector<float> keys=make_workload(workloads[index],options.size,options.seed);
+    vector<float> probes(keys);
+    sort(probes.begin(),probes.end());
+    probes.erase(unique(probes.begin(),probes.end()),probes.end());
+    shuffle(probes.begin(),probes.end(),mt19937(options.seed+1));
+
+    run_subject<avl_subject>(workloads[index],keys,probes,options,results);
+    run_subject<set_subject>(workloads[index],keys,probes,options,results);
+    run_subject<vector_subject>(workloads[index],keys,probes,options,results);
+    run_hinted(workloads[index],keys,results);
+    run_multi(workloads[index],keys,probes,results);
+    run_lazy(workloads[index],keys,probes,results);
+    run_frozen(workloads[index],keys,probes,results);
+  }
+
+  // Node size drives the cache footprint of every avl row.
+  printf("avl_node: %zu bytes\n",sizeof(struct avl_node));
+  printf("%-14s %-9s %-11s %10s %10s %10s %14s\n",
+         "structure","operation","workload","p50_ns","p99_ns","p999_ns","ops_per_sec");
+  for (size_t index = 0; index < results.size(); index++){
+    const struct bench_result &result=results[index];
+    printf("%-14s %-9s %-11s %10.0f %10.0f %10.0f %14.0f\n",result.structure.c_str(),
+           result.operation.c_str(),result.workload.c_str(),result.p50_ns,
+           result.p99_ns,result.p999_ns,result.ops_per_sec);
+  }
+
+  if (!write_results(options.output,results)){
+    fprintf(stderr,"could not write %s\n",options.output.c_str());
+    return 1;
+  }
+  if (!options.compare.empty()){
+    int regressions=compare_results(options.compare,options.tolerance,results);
+    if (regressions<0){
+      fprintf(stderr,"could not read %s\n",options.compare.c_str());
+      return 1;
+    }
+    return regressions>0 ? 1 : 0;
+  }
+  return 0;
+}
@@ -0,0 +1,210 @@
+#ifndef AVL_COMPACT_H
+#define AVL_COMPACT_H
+
+#include <cstdint>
+#include "AVL_tree.hpp"
+
+/** Índice que representa un hijo inexistente */
+#define AVL_COMPACT_NIL 0x3FFFFFFFu
+
+/** Máscara de los 30 bits de índice del campo rc_bal */
+#define AVL_COMPACT_INDEX_MASK 0x3FFFFFFFu
+
+/** Desplazamiento de los 2 bits de factor de balance en rc_bal */
+#define AVL_COMPACT_BALANCE_SHIFT 30
+
+/**
+ * Struct que define un nodo compacto (12 bytes). Los hijos son índices de
+ * 32 bits dentro del arreglo de nodos del árbol y el factor de balance se
+ * guarda en los 2 bits altos del índice del hijo derecho.
+ */
+struct avl_compact_node {
+  /** Número flotante asociado al nodo */
+  float value;
+
+  /** Índice del hijo izquierdo (AVL_COMPACT_NIL si no existe) */
+  uint32_t lc_index;
+
+  /** Índice del hijo derecho (30 bits) y factor de balance (2 bits) */
+  uint32_t rc_bal;
+};
+
+/**
+ * Struct que define un árbol compacto, con todos sus nodos en un arreglo
+ * contiguo. Las posiciones liberadas se reutilizan mediante una lista libre.
+ */
+struct avl_compact_tree {
+  /** Arreglo contiguo de nodos */
+  struct avl_compact_node *nodes;
+
+  /** Cantidad de nodos reservados en el arreglo */
+  uint32_t capacity;
+
+  /** Cantidad de posiciones del arreglo usadas alguna vez */
+  uint32_t used;
+
+  /** Índice del nodo raíz (AVL_COMPACT_NIL si el árbol está vacío) */
+  uint32_t root;
+
+  /** Lista libre de posiciones eliminadas, enlazada por lc_index */
+  uint32_t free_list;
+
+  /** Cantidad de nodos en el árbol */
+  uint32_t size;
+};
+
+
+/**
+ * avl_compact_lc
+ * Obtiene el índice del hijo izquierdo de un nodo compacto.
+ *
+ * @param [in]  node  Nodo compacto.
+ *
+ * @returns index Índice del hijo izquierdo.
+ */
+inline uint32_t avl_compact_lc(
+  const struct avl_compact_node &node){
+    return node.lc_index;
+}
+
+/**
+ * avl_compact_rc
+ * Obtiene el índice del hijo derecho de un nodo compacto.
+ *
+ * @param [in]  node  Nodo compacto.
+ *
+ * @returns index Índice del hijo derecho.
+ */
+inline uint32_t avl_compact_rc(
+  const struct avl_compact_node &node){
+    return node.rc_bal & AVL_COMPACT_INDEX_MASK;
+}
+
+/**
+ * avl_compact_balance
+ * Obtiene el factor de balance h(LeftChild)-h(RightChild) de un nodo compacto.
+ *
+ * @param [in]  node  Nodo compacto.
+ *
+ * @returns balance_factor Factor de balance (-1, 0 o 1).
+ */
+inline int avl_compact_balance(
+  const struct avl_compact_node &node){
+    // Bits: 0 balanced, 1 left heavy, 2 right heavy.
+    uint32_t bits=node.rc_bal >> AVL_COMPACT_BALANCE_SHIFT;
+    return (bits==1) ? 1 : ((bits==2) ? -1 : 0);
+}
+
+
+/**
+ * avl_compact_init
+ * Inicializa un árbol compacto vacío.
+ *
+ * @param [out] tree      Puntero al árbol.
+ * @param [in]  capacity  Cantidad inicial de nodos por reservar.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_compact_init(
+  struct avl_compact_tree *tree,
+  uint32_t                 capacity);
+
+/**
+ * avl_compact_free
+ * Libera el arreglo de nodos del árbol compacto de una sola vez.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ */
+void avl_compact_free(
+  struct avl_compact_tree *tree);
+
+/**
+ * avl_compact_create
+ * Toma una lista de números flotantes y los inserta en un árbol compacto.
+ *
+ * @param [in]     in_number_list Lista de números flotantes de entrada.
+ * @param [in]     list_size      Tamaño de la lista.
+ * @param [in/out] tree           Árbol inicializado con avl_compact_init.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_compact_create(
+  float                   *in_number_list,
+  int                      list_size,
+  struct avl_compact_tree *tree);
+
+/**
+ * avl_compact_add
+ * Inserta un número en el árbol compacto. Los repetidos se ignoran.
+ *
+ * @param [in]     num   Número por insertar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_compact_add(
+  float                    num,
+  struct avl_compact_tree *tree);
+
+/**
+ * avl_compact_remove
+ * Busca un número y lo elimina del árbol compacto.
+ * Da error si el número no pertenece al árbol.
+ *
+ * @param [in]     num   Número por eliminar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_compact_remove(
+  float                    num,
+  struct avl_compact_tree *tree);
+
+/**
+ * avl_compact_search
+ * Busca un número y devuelve el índice del nodo que lo contiene.
+ *
+ * @param [in]  num          Número por buscar.
+ * @param [in]  tree         Puntero al árbol.
+ * @param [out] found_index  Índice del nodo encontrado.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_compact_search(
+  float                          num,
+  const struct avl_compact_tree *tree,
+  uint32_t                      *found_index);
+
+/**
+ * avl_compact_max_get
+ * Obtiene el índice del nodo con el valor máximo del árbol compacto.
+ *
+ * @param [in]  tree       Puntero al árbol.
+ * @param [out] max_index  Índice del nodo con el valor máximo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_compact_max_get(
+  const struct avl_compact_tree *tree,
+  uint32_t                      *max_index);
+
+/**
+ * avl_compact_min_get
+ * Obtiene el índice del nodo con el valor mínimo del árbol compacto.
+ *
+ * @param [in]  tree       Puntero al árbol.
+ * @param [out] min_index  Índice del nodo con el valor mínimo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_compact_min_get(
+  const struct avl_compact_tree *tree,
+  uint32_t                      *min_index);
+
+
+#endif /* AVL_COMPACT_H */
@@ -0,0 +1,157 @@
+#ifndef AVL_CONCURRENT_H
+#define AVL_CONCURRENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "AVL_tree.hpp"
+
+/**
+ * Struct que define un nodo del árbol concurrente. Los lectores recorren los
+ * nodos sin tomar locks y validan cada paso con la versión del nodo; los
+ * escritores toman el lock del padre y del nodo antes de enlazar, desenlazar
+ * o rotar. Eliminar un nodo con dos hijos solo lo marca como ausente, y el
+ * nodo queda como nodo de ruteo hasta que pueda desenlazarse.
+ */
+struct avl_cnode {
+  /** Puntero al nodo hijo izquierdo */
+  std::atomic<struct avl_cnode *> lc_node;
+
+  /** Puntero al nodo hijo derecho */
+  std::atomic<struct avl_cnode *> rc_node;
+
+  /** Puntero al nodo padre */
+  std::atomic<struct avl_cnode *> parent;
+
+  /** Número flotante asociado al nodo */
+  float value;
+
+  /** Indica si el número pertenece al árbol o si es un nodo de ruteo */
+  std::atomic<bool> present;
+
+  /** Altura del subárbol con raíz en el nodo */
+  std::atomic<int> height;
+
+  /**
+   * Versión del nodo: el bit 0 indica una rotación en curso que achica el
+   * subárbol, el bit 1 que el nodo fue desenlazado, y cada rotación
+   * terminada suma 4
+   */
+  std::atomic<uint64_t> version;
+
+  /** Lock tomado por los escritores que modifican el nodo */
+  std::mutex lock;
+
+  /** Siguiente nodo en la lista de nodos desenlazados */
+  struct avl_cnode *retired_next;
+};
+
+/**
+ * Struct que define un árbol concurrente. La raíz es el hijo derecho de un
+ * nodo centinela que nunca se rota ni se desenlaza.
+ */
+struct avl_concurrent_tree {
+  /** Nodo centinela */
+  struct avl_cnode *holder;
+
+  /**
+   * Época de reclamación. Cada operación anota la época en la que entra, y la
+   * época solo avanza cuando no queda ninguna operación de la anterior
+   */
+  std::atomic<uint64_t> epoch;
+
+  /** Operaciones en curso que entraron en una época par o impar */
+  std::atomic<int> active[2];
+
+  /**
+   * Nodos desenlazados en cada una de las últimas tres épocas. Un lector
+   * puede seguir recorriéndolos, así que los de la época e se liberan recién
+   * cuando la época llega a e+2
+   */
+  std::atomic<struct avl_cnode *> retired[3];
+};
+
+
+/**
+ * avl_concurrent_init
+ * Inicializa un árbol concurrente vacío.
+ *
+ * @param [out] tree  Puntero al árbol.
+ */
+void avl_concurrent_init(
+  struct avl_concurrent_tree *tree);
+
+/**
+ * avl_concurrent_free
+ * Libera todos los nodos del árbol, incluidos los desenlazados. No debe
+ * haber operaciones en curso sobre el árbol.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ */
+void avl_concurrent_free(
+  struct avl_concurrent_tree *tree);
+
+/**
+ * avl_concurrent_reclaim
+ * Libera los nodos desenlazados hasta el momento. No debe haber operaciones
+ * en curso sobre el árbol. No hace falta llamarla para acotar la memoria:
+ * cada operación, al terminar, avanza la época si ya no quedan operaciones
+ * de la anterior y libera los nodos desenlazados dos épocas atrás. Un hilo
+ * que queda dentro de una operación (ej. bloqueado en un lock) frena ese
+ * avance, y los nodos desenlazados mientras tanto se acumulan hasta que
+ * termine.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns freed Cantidad de nodos liberados.
+ */
+int avl_concurrent_reclaim(
+  struct avl_concurrent_tree *tree);
+
+/**
+ * avl_concurrent_add
+ * Inserta un número en el árbol. Puede llamarse desde varios hilos a la vez.
+ * Los repetidos se ignoran.
+ *
+ * @param [in]     num   Número por insertar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_concurrent_add(
+  float                       num,
+  struct avl_concurrent_tree *tree);
+
+/**
+ * avl_concurrent_remove
+ * Elimina un número del árbol. Puede llamarse desde varios hilos a la vez.
+ * Da error si el número no pertenece al árbol.
+ *
+ * @param [in]     num   Número por eliminar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_concurrent_remove(
+  float                       num,
+  struct avl_concurrent_tree *tree);
+
+/**
+ * avl_concurrent_search
+ * Busca un número sin tomar locks. Como otro hilo puede liberar el nodo,
+ * solo se informa si el número pertenece al árbol.
+ *
+ * @param [in]  num   Número por buscar.
+ * @param [in]  tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_concurrent_search(
+  float                       num,
+  struct avl_concurrent_tree *tree);
+
+
+#endif /* AVL_CONCURRENT_H */
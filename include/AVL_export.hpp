@@ -0,0 +1,112 @@
+#ifndef AVL_EXPORT_H
+#define AVL_EXPORT_H
+
+#include <cstddef>
+#include "AVL_tree.hpp"
+
+/** Tamaño por defecto del buffer de escritura (1 MiB) */
+#define AVL_EXPORT_BUFFER_SIZE (1 << 20)
+
+/** Formatos de exportación */
+enum avl_export_format {
+  /** Un número por línea, con precisión suficiente para recuperar el float */
+  AVL_EXPORT_TEXT   = 0,
+
+  /** Los 4 bytes de cada float en el orden de bytes de la máquina */
+  AVL_EXPORT_BINARY = 1
+};
+
+/**
+ * Struct que define un escritor con buffer sobre un descriptor de archivo.
+ * Los números se formatean directamente en el buffer, que se escribe con
+ * una sola llamada a write cuando se llena.
+ */
+struct avl_writer {
+  /** Descriptor de archivo de destino */
+  int fd;
+
+  /** Formato de salida (avl_export_format) */
+  int format;
+
+  /** Buffer de salida */
+  char *buffer;
+
+  /** Tamaño del buffer en bytes */
+  size_t capacity;
+
+  /** Bytes pendientes en el buffer */
+  size_t used;
+};
+
+
+/**
+ * avl_writer_init
+ * Inicializa un escritor sobre un descriptor de archivo ya abierto.
+ *
+ * @param [out] writer    Puntero al escritor.
+ * @param [in]  fd        Descriptor de archivo de destino.
+ * @param [in]  format    Formato de salida (avl_export_format).
+ * @param [in]  capacity  Tamaño del buffer (ej. AVL_EXPORT_BUFFER_SIZE).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_writer_init(
+  struct avl_writer *writer,
+  int                fd,
+  int                format,
+  size_t             capacity);
+
+/**
+ * avl_writer_put
+ * Agrega un número al buffer, escribiéndolo si se llena.
+ *
+ * @param [in/out] writer  Puntero al escritor.
+ * @param [in]     value   Número por escribir.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_writer_put(
+  struct avl_writer *writer,
+  float              value);
+
+/**
+ * avl_writer_flush
+ * Escribe los bytes pendientes del buffer.
+ *
+ * @param [in/out] writer  Puntero al escritor.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_writer_flush(
+  struct avl_writer *writer);
+
+/**
+ * avl_writer_release
+ * Libera el buffer del escritor sin escribir los bytes pendientes. El
+ * descriptor de archivo no se cierra.
+ *
+ * @param [in/out] writer  Puntero al escritor.
+ */
+void avl_writer_release(
+  struct avl_writer *writer);
+
+/**
+ * avl_export
+ * Escribe todos los valores del árbol en un descriptor de archivo, en el
+ * orden de recorrido pedido, con un buffer de AVL_EXPORT_BUFFER_SIZE.
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ * @param [in]  order    orden de recorrido (avl_traversal_order)
+ * @param [in]  fd       Descriptor de archivo de destino.
+ * @param [in]  format   Formato de salida (avl_export_format).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_export(
+  struct avl_node *in_root,
+  int              order,
+  int              fd,
+  int              format);
+
+
+#endif /* AVL_EXPORT_H */
@@ -0,0 +1,203 @@
+#ifndef AVL_FOREST_H
+#define AVL_FOREST_H
+
+#include <atomic>
+#include <mutex>
+#include "AVL_tree.hpp"
+
+/**
+ * Un fragmento con más de AVL_FOREST_SKEW veces el promedio de números
+ * dispara el rebalanceo de los límites
+ */
+#define AVL_FOREST_SKEW 2
+
+/**
+ * Fracción del total que dispara el rebalanceo aunque no alcance
+ * AVL_FOREST_SKEW veces el promedio, como pasa con 2 fragmentos
+ */
+#define AVL_FOREST_MAX_SHARE 0.75
+
+/** Cantidad mínima de números en el bosque para rebalancear automáticamente */
+#define AVL_FOREST_MIN_REBALANCE 1024
+
+/**
+ * Struct que define un fragmento del bosque: un árbol AVL con su propio lock
+ * y su propio pool de nodos, dueño de los números en [low, low del
+ * siguiente fragmento).
+ */
+struct avl_shard {
+  /** Raíz del árbol del fragmento */
+  struct avl_node *root;
+
+  /** Pool de nodos del fragmento */
+  struct avl_pool pool;
+
+  /** Protege el árbol y el pool del fragmento */
+  std::mutex lock;
+
+  /** Límite inferior (incluido) del intervalo del fragmento */
+  std::atomic<float> low;
+
+  /** Cantidad de números en el fragmento */
+  std::atomic<int> size;
+};
+
+/**
+ * Struct que define un bosque de árboles AVL particionado por rangos. Cada
+ * escritor toma solo el lock del fragmento al que pertenece su número; el
+ * rebalanceo de límites toma todos los locks en orden.
+ */
+struct avl_forest {
+  /** Arreglo de fragmentos, ordenados por intervalo */
+  struct avl_shard *shards;
+
+  /** Cantidad de fragmentos */
+  int shard_count;
+
+  /** Cantidad total de números en el bosque */
+  std::atomic<int> size;
+};
+
+
+/**
+ * avl_forest_init
+ * Inicializa un bosque vacío repartiendo [low, high) en intervalos iguales.
+ * Los números fuera de ese intervalo van a los fragmentos de los extremos.
+ *
+ * @param [out] forest       Puntero al bosque.
+ * @param [in]  shard_count  Cantidad de fragmentos.
+ * @param [in]  low          Límite inferior esperado de los números.
+ * @param [in]  high         Límite superior esperado de los números.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_forest_init(
+  struct avl_forest *forest,
+  int                shard_count,
+  float              low,
+  float              high);
+
+/**
+ * avl_forest_free
+ * Libera todos los fragmentos del bosque.
+ *
+ * @param [in/out] forest  Puntero al bosque.
+ */
+void avl_forest_free(
+  struct avl_forest *forest);
+
+/**
+ * avl_forest_add
+ * Inserta un número en el fragmento que le corresponde. Si el fragmento
+ * queda desbalanceado respecto del resto, rebalancea los límites. NaN no
+ * pertenece a ningún fragmento y da AVL_INVALID_PARAM.
+ *
+ * @param [in]     num     Número por insertar.
+ * @param [in/out] forest  Puntero al bosque.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_add(
+  float              num,
+  struct avl_forest *forest);
+
+/**
+ * avl_forest_remove
+ * Elimina un número del fragmento que le corresponde.
+ * Da error si el número no pertenece al bosque, y AVL_INVALID_PARAM si es
+ * NaN.
+ *
+ * @param [in]     num     Número por eliminar.
+ * @param [in/out] forest  Puntero al bosque.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_remove(
+  float              num,
+  struct avl_forest *forest);
+
+/**
+ * avl_forest_search
+ * Busca un número en el fragmento que le corresponde. Como otro hilo puede
+ * liberar el nodo, solo se informa si el número pertenece al bosque. NaN
+ * da AVL_INVALID_PARAM.
+ *
+ * @param [in]  num     Número por buscar.
+ * @param [in]  forest  Puntero al bosque.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_search(
+  float              num,
+  struct avl_forest *forest);
+
+/**
+ * avl_forest_min_get
+ * Obtiene el valor mínimo del bosque: el mínimo del primer fragmento no
+ * vacío.
+ *
+ * @param [in]  forest     Puntero al bosque.
+ * @param [out] min_value  Valor mínimo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_min_get(
+  struct avl_forest *forest,
+  float             *min_value);
+
+/**
+ * avl_forest_max_get
+ * Obtiene el valor máximo del bosque: el máximo del último fragmento no
+ * vacío.
+ *
+ * @param [in]  forest     Puntero al bosque.
+ * @param [out] max_value  Valor máximo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_max_get(
+  struct avl_forest *forest,
+  float             *max_value);
+
+/**
+ * avl_forest_range_scan
+ * Visita en orden creciente los nodos con valor en [low, high), recorriendo
+ * los fragmentos que cortan el intervalo uno por uno con su lock tomado.
+ * Da AVL_INVALID_PARAM si low > high o si algún límite es NaN.
+ *
+ * @param [in]  forest   Puntero al bosque.
+ * @param [in]  low      límite inferior (incluido)
+ * @param [in]  high     límite superior (excluido)
+ * @param [in]  visit    función llamada con cada nodo del intervalo
+ * @param [in]  context  puntero del usuario entregado a visit
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_forest_range_scan(
+  struct avl_forest *forest,
+  float              low,
+  float              high,
+  avl_visitor        visit,
+  void              *context);
+
+/**
+ * avl_forest_rebalance
+ * Reparte los números en fragmentos de igual tamaño: toma todos los locks,
+ * recalcula los límites y reconstruye cada fragmento con
+ * avl_pool_build_sorted.
+ *
+ * @param [in/out] forest  Puntero al bosque.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_forest_rebalance(
+  struct avl_forest *forest);
+
+
+#endif /* AVL_FOREST_H */
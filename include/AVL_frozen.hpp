@@ -0,0 +1,107 @@
+#ifndef AVL_FROZEN_H
+#define AVL_FROZEN_H
+
+#include <cstdint>
+#include "AVL_tree.hpp"
+
+/**
+ * Cantidad máxima de valores de un árbol congelado. La búsqueda por lotes
+ * guarda en enteros de 32 bits con signo el índice del siguiente nivel, que
+ * llega a 2*count+1
+ */
+#define AVL_FROZEN_MAX_KEYS ((INT32_MAX-1)/2)
+
+/**
+ * Struct que define un árbol congelado: los valores de un árbol AVL en un
+ * arreglo implícito en orden de Eytzinger (por niveles, como un heap). Los
+ * hijos del índice k están en 2k y 2k+1, así que la búsqueda no sigue
+ * punteros y puede pedir por adelantado los niveles siguientes. El índice 0
+ * no se usa y significa "no encontrado".
+ */
+struct avl_frozen_tree {
+  /** Valores en orden de Eytzinger, desde el índice 1, alineados a 64 bytes */
+  float *keys;
+
+  /** Cantidad de valores */
+  uint32_t count;
+};
+
+
+/**
+ * avl_freeze
+ * Copia los valores de un árbol en un árbol congelado de solo lectura. El
+ * árbol original no se modifica y puede liberarse después. Da
+ * AVL_OUT_OF_RANGE si el árbol tiene más de AVL_FROZEN_MAX_KEYS valores o
+ * si no hay memoria para el arreglo.
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ * @param [out] frozen   Árbol congelado.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_freeze(
+  struct avl_node        *in_root,
+  struct avl_frozen_tree *frozen);
+
+/**
+ * avl_frozen_free
+ * Libera el arreglo de un árbol congelado.
+ *
+ * @param [in/out] frozen  Árbol congelado.
+ */
+void avl_frozen_free(
+  struct avl_frozen_tree *frozen);
+
+/**
+ * avl_frozen_search
+ * Busca un número sin saltos condicionales en el descenso.
+ *
+ * @param [in]  num          Número por buscar.
+ * @param [in]  frozen       Árbol congelado.
+ * @param [out] found_index  Índice del valor encontrado en frozen->keys.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_frozen_search(
+  float                         num,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *found_index);
+
+/**
+ * avl_frozen_lower_bound
+ * Obtiene el menor valor mayor o igual a num.
+ *
+ * @param [in]  num          Número de referencia.
+ * @param [in]  frozen       Árbol congelado.
+ * @param [out] found_index  Índice del valor encontrado en frozen->keys.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_frozen_lower_bound(
+  float                         num,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *found_index);
+
+/**
+ * avl_frozen_lower_bound_batch
+ * Resuelve lower_bound para un lote de números. Con AVX2 disponible
+ * desciende ocho búsquedas a la vez, comparando ocho valores por
+ * instrucción; si no, repite la búsqueda escalar.
+ *
+ * @param [in]  nums     Números de referencia.
+ * @param [in]  count    Cantidad de números.
+ * @param [in]  frozen   Árbol congelado.
+ * @param [out] indices  Índice del resultado de cada número (0 si no hay).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_frozen_lower_bound_batch(
+  const float                  *nums,
+  int                           count,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *indices);
+
+
+#endif /* AVL_FROZEN_H */
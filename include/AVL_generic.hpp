@@ -0,0 +1,2073 @@
+#ifndef AVL_GENERIC_H
+#define AVL_GENERIC_H
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "AVL_tree.hpp"
+#include "AVL_stats.hpp"
+#include "AVL_trace.hpp"
+
+/**
+ * Tamaño mínimo de ambos subárboles para que una operación de conjuntos
+ * resuelva sus dos mitades en hilos distintos
+ */
+#define AVL_PARALLEL_GRAIN 4096
+
+/**
+ * Algoritmos AVL genéricos sobre cualquier tipo de nodo con los campos
+ * lc_node, rc_node, parent, height y size. La llave de cada nodo se obtiene con un
+ * functor KeyOf y se compara con un functor Compare, ambos resueltos en
+ * tiempo de compilación. Tanto avl_tree como las funciones de flotantes de
+ * AVL_tree.hpp se construyen sobre estos algoritmos.
+ */
+namespace avl_detail {
+
+/**
+ * height
+ * Obtiene la altura almacenada de un nodo (0 para un nodo nulo).
+ */
+template<class Node>
+inline int height(
+  const Node *node){
+    return (node==nullptr) ? 0 : node->height;
+}
+
+/**
+ * size
+ * Obtiene la cantidad de nodos del subárbol (0 para un nodo nulo).
+ */
+template<class Node>
+inline int size(
+  const Node *node){
+    return (node==nullptr) ? 0 : node->size;
+}
+
+/**
+ * update_total
+ * Los nodos sin repeticiones no tienen nada más que recalcular.
+ */
+template<class Node>
+inline void update_total(
+  Node *){
+}
+
+/**
+ * update_total
+ * Recalcula la suma de repeticiones del subárbol de un nodo de flotantes.
+ */
+inline void update_total(
+  struct avl_node *node){
+    node->total=((node->lc_node==nullptr) ? 0 : node->lc_node->total)+
+                ((node->rc_node==nullptr) ? 0 : node->rc_node->total)+node->count;
+}
+
+/**
+ * update
+ * Recalcula la altura y el tamaño almacenados de un nodo a partir de sus
+ * hijos.
+ */
+template<class Node>
+inline void update(
+  Node *node){
+    int left_height=height(node->lc_node);
+    int right_height=height(node->rc_node);
+    node->height=((left_height > right_height) ? left_height : right_height)+1;
+    node->size=size(node->lc_node)+size(node->rc_node)+1;
+    update_total(node);
+}
+
+/**
+ * adopt
+ * Apunta el padre de los hijos de un nodo hacia el nodo y recalcula su
+ * altura y tamaño. Se usa al armar subárboles enlazando hijos directamente.
+ */
+template<class Node>
+inline void adopt(
+  Node *node){
+    if (node->lc_node != nullptr){
+        node->lc_node->parent=node;
+    }
+    if (node->rc_node != nullptr){
+        node->rc_node->parent=node;
+    }
+    update(node);
+}
+
+/**
+ * balance
+ * Calcula el factor de balance h(LeftChild)-h(RightChild) de un nodo.
+ */
+template<class Node>
+inline int balance(
+  const Node *node){
+    return height(node->lc_node)-height(node->rc_node);
+}
+
+/**
+ * rotate_left
+ * Rotación a la izquierda sobre el nodo en *top, que debe tener hijo derecho.
+ */
+template<class Node>
+inline void rotate_left(
+  Node **top){
+    Node *rc=(*top)->rc_node;
+    (*top)->rc_node=rc->lc_node;
+    if (rc->lc_node != nullptr){
+        rc->lc_node->parent=*top;
+    }
+    rc->lc_node=*top;
+    rc->parent=(*top)->parent;
+    (*top)->parent=rc;
+    update(*top);
+    update(rc);
+    *top=rc;
+}
+
+/**
+ * rotate_right
+ * Rotación a la derecha sobre el nodo en *top, que debe tener hijo izquierdo.
+ */
+template<class Node>
+inline void rotate_right(
+  Node **top){
+    Node *lc=(*top)->lc_node;
+    (*top)->lc_node=lc->rc_node;
+    if (lc->rc_node != nullptr){
+        lc->rc_node->parent=*top;
+    }
+    lc->rc_node=*top;
+    lc->parent=(*top)->parent;
+    (*top)->parent=lc;
+    update(*top);
+    update(lc);
+    *top=lc;
+}
+
+/**
+ * rebalance_node
+ * Recalcula la altura del nodo en *link y lo rota si quedó desbalanceado.
+ */
+template<class Node>
+inline void rebalance_node(
+  Node **link){
+
+    update(*link);
+    int node_balance=balance(*link);
+
+    // Left heavy: Left Right Case turns into Left Left Case.
+    if (node_balance > 1){
+        AVL_TRACE_SPAN("rotate_right");
+        bool is_double=balance((*link)->lc_node) < 0;
+        AVL_STATS_ROTATION(is_double);
+        if (is_double){
+            rotate_left(&((*link)->lc_node));
+        }
+        rotate_right(link);
+    }
+
+    // Right heavy: Right Left Case turns into Right Right Case.
+    else if (node_balance < -1){
+        AVL_TRACE_SPAN("rotate_left");
+        bool is_double=balance((*link)->rc_node) > 0;
+        AVL_STATS_ROTATION(is_double);
+        if (is_double){
+            rotate_right(&((*link)->rc_node));
+        }
+        rotate_left(link);
+    }
+}
+
+/**
+ * rebalance_path
+ * Rebalancea los enlaces de un camino desde el más profundo hasta la raíz.
+ * En cuanto la altura de un subárbol no cambia, los ancestros solo
+ * actualizan su tamaño.
+ */
+template<class Node>
+inline void rebalance_path(
+  Node ***path,
+  int     depth){
+
+    bool height_stable=false;
+    for (int index = depth-1; index >= 0; index--){
+        Node **link=path[index];
+
+        // Ancestors of an unchanged height only need their size refreshed.
+        if (height_stable){
+            update(*link);
+            continue;
+        }
+
+        int old_height=(*link)->height;
+        rebalance_node(link);
+        height_stable=((*link)->height==old_height);
+    }
+}
+
+/**
+ * find
+ * Busca la llave en el árbol. Retorna el nodo o nullptr si no existe.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *find(
+  Node          *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    int depth=0;
+    while (root != nullptr){
+        if (compare(key,key_of(root))){
+            root=root->lc_node;
+        }
+        else if (compare(key_of(root),key)){
+            root=root->rc_node;
+        }
+        else {
+            AVL_STATS_DEPTH(depth);
+            return root;
+        }
+        depth++;
+    }
+    AVL_STATS_DEPTH(depth);
+    return nullptr;
+}
+
+/**
+ * insert
+ * Inserta la llave descendiendo una sola vez con una pila de caminos y
+ * rebalanceando de regreso. El nodo nuevo se obtiene de make(&node), que solo
+ * se llama si la llave no existía y retorna un código de error.
+ * found_node recibe el nodo que contiene la llave.
+ */
+template<class Node, class Key, class Compare, class KeyOf, class Make>
+inline int insert(
+  Node          **root,
+  const Key      &key,
+  const Compare  &compare,
+  const KeyOf    &key_of,
+  Make            make,
+  Node          **found_node){
+
+    // Links followed from the root, bounded by the maximum AVL height.
+    Node **path[AVL_MAX_HEIGHT];
+    int depth=0;
+    Node **link=root;
+
+    // Descend recording the path until an empty link is found.
+    while (*link != nullptr){
+        if (compare(key,key_of(*link))){
+            path[depth++]=link;
+            link=&((*link)->lc_node);
+        }
+        else if (compare(key_of(*link),key)){
+            path[depth++]=link;
+            link=&((*link)->rc_node);
+        }
+        else {
+            // Key already present.
+            AVL_STATS_DEPTH(depth);
+            *found_node=*link;
+            return AVL_SUCCESS;
+        }
+    }
+    AVL_STATS_DEPTH(depth);
+
+    // Create the new node on the empty link.
+    int status=make(link);
+    if (status!=AVL_SUCCESS){
+        return status;
+    }
+    (*link)->parent=(depth > 0) ? *path[depth-1] : nullptr;
+    *found_node=*link;
+
+    // Rebalance on the way back up.
+    rebalance_path(path,depth);
+    return AVL_SUCCESS;
+}
+
+/**
+ * unlink
+ * Quita del árbol el nodo con la llave dada sin liberarlo, y lo devuelve en
+ * removed_node para que el dueño lo libere. Un nodo con dos hijos se
+ * reemplaza por el mínimo de su subárbol derecho, reenlazándolo.
+ * Retorna AVL_NOT_FOUND si el árbol está vacío y AVL_OUT_OF_RANGE si la
+ * llave no existe.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline int unlink(
+  Node          **root,
+  const Key      &key,
+  const Compare  &compare,
+  const KeyOf    &key_of,
+  Node          **removed_node){
+
+    // Links followed from the root, bounded by the maximum AVL height.
+    Node **path[AVL_MAX_HEIGHT];
+    int depth=0;
+    Node **link=root;
+
+    //if nullptr then avl is empty or doesnt exist.
+    if (*root == nullptr){
+        return AVL_NOT_FOUND;
+    }
+
+    // Descend recording the path until the key is found.
+    while (*link != nullptr){
+        if (compare(key,key_of(*link))){
+            path[depth++]=link;
+            link=&((*link)->lc_node);
+        }
+        else if (compare(key_of(*link),key)){
+            path[depth++]=link;
+            link=&((*link)->rc_node);
+        }
+        else {
+            break;
+        }
+    }
+
+    // Key is not part of the tree.
+    AVL_STATS_DEPTH(depth);
+    if (*link == nullptr){
+        return AVL_OUT_OF_RANGE;
+    }
+
+    Node *temp=*link;
+
+    // A node with one child or none is replaced by that child.
+    if (temp->rc_node == nullptr || temp->lc_node == nullptr){
+        *link=(temp->rc_node != nullptr) ? temp->rc_node : temp->lc_node;
+        if (*link != nullptr){
+            (*link)->parent=temp->parent;
+        }
+    }
+    else {
+        // Two children, find the right min.
+        int node_depth=depth;
+        path[depth++]=link;
+        Node **min_link=&(temp->rc_node);
+        while ((*min_link)->lc_node != nullptr){
+            path[depth++]=min_link;
+            min_link=&((*min_link)->lc_node);
+        }
+
+        // Unlink the right min and move it to the place of the node.
+        Node *min_node=*min_link;
+        *min_link=min_node->rc_node;
+        if (min_node->rc_node != nullptr){
+            min_node->rc_node->parent=min_node->parent;
+        }
+        min_node->lc_node=temp->lc_node;
+        min_node->rc_node=temp->rc_node;
+        if (min_node->lc_node != nullptr){
+            min_node->lc_node->parent=min_node;
+        }
+        if (min_node->rc_node != nullptr){
+            min_node->rc_node->parent=min_node;
+        }
+        min_node->parent=temp->parent;
+        min_node->height=temp->height;
+        min_node->size=temp->size;
+        *link=min_node;
+
+        // The first link below the node now belongs to the right min.
+        if (depth > node_depth+1){
+            path[node_depth+1]=&(min_node->rc_node);
+        }
+    }
+    temp->lc_node=nullptr;
+    temp->rc_node=nullptr;
+    temp->parent=nullptr;
+    *removed_node=temp;
+
+    // Rebalance on the way back up.
+    rebalance_path(path,depth);
+    return AVL_SUCCESS;
+}
+
+/**
+ * leftmost
+ * Retorna el nodo de menor llave del subárbol (nullptr si está vacío).
+ */
+template<class Node>
+inline Node *leftmost(
+  Node *root){
+    if (root != nullptr){
+        while (root->lc_node != nullptr){
+            root=root->lc_node;
+        }
+    }
+    return root;
+}
+
+/**
+ * rightmost
+ * Retorna el nodo de mayor llave del subárbol (nullptr si está vacío).
+ */
+template<class Node>
+inline Node *rightmost(
+  Node *root){
+    if (root != nullptr){
+        while (root->rc_node != nullptr){
+            root=root->rc_node;
+        }
+    }
+    return root;
+}
+
+/**
+ * next
+ * Retorna el sucesor en orden de un nodo siguiendo los punteros al padre, o
+ * nullptr si es el último. Costo amortizado O(1) al recorrer todo el árbol.
+ */
+template<class Node>
+inline Node *next(
+  Node *node){
+    if (node->rc_node != nullptr){
+        return leftmost(node->rc_node);
+    }
+    while (node->parent != nullptr && node->parent->rc_node == node){
+        node=node->parent;
+    }
+    return node->parent;
+}
+
+/**
+ * prev
+ * Retorna el predecesor en orden de un nodo, o nullptr si es el primero.
+ */
+template<class Node>
+inline Node *prev(
+  Node *node){
+    if (node->lc_node != nullptr){
+        return rightmost(node->lc_node);
+    }
+    while (node->parent != nullptr && node->parent->lc_node == node){
+        node=node->parent;
+    }
+    return node->parent;
+}
+
+/**
+ * link_of
+ * Retorna el enlace que apunta al nodo: el de su padre o la raíz.
+ */
+template<class Node>
+inline Node **link_of(
+  Node **root,
+  Node  *node){
+    Node *parent=node->parent;
+    if (parent == nullptr){
+        return root;
+    }
+    return (parent->lc_node == node) ? &(parent->lc_node) : &(parent->rc_node);
+}
+
+/**
+ * rebalance_up
+ * Como rebalance_path, pero sube por los punteros al padre desde node
+ * hasta la raíz, sin pila de enlaces.
+ */
+template<class Node>
+inline void rebalance_up(
+  Node **root,
+  Node  *node){
+
+    bool height_stable=false;
+    while (node != nullptr){
+        Node *parent=node->parent;
+
+        // Ancestors of an unchanged height only need their size refreshed.
+        if (height_stable){
+            update(node);
+        }
+        else {
+            Node **link=link_of(root,node);
+            int old_height=node->height;
+            rebalance_node(link);
+            height_stable=((*link)->height==old_height);
+        }
+        node=parent;
+    }
+}
+
+/**
+ * finger
+ * Retorna el nodo desde el que se busca key partiendo de hint. Sube por los
+ * padres y solo compara con los ancestros que acotan a hint del lado de
+ * key; el resultado es el más alto de los que no la acotan, así que la
+ * posición de key queda en su subárbol. Con hint en el máximo y key mayor,
+ * la subida no compara llaves y el resultado es hint.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *finger(
+  Node          *hint,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    bool right=compare(key_of(hint),key);
+    if (!right && !compare(key,key_of(hint))){
+        return hint;
+    }
+
+    // Only a parent reached from the side of key bounds hint there. The
+    // ones that do not bound it lie between hint and key.
+    Node *start=hint;
+    Node *node=hint;
+    while (node->parent != nullptr){
+        Node *parent=node->parent;
+        if (right ? (parent->lc_node == node) : (parent->rc_node == node)){
+            if (right ? compare(key,key_of(parent)) : compare(key_of(parent),key)){
+                break;
+            }
+            start=parent;
+        }
+        node=parent;
+    }
+    return start;
+}
+
+/**
+ * insert_hint
+ * Igual que insert, pero la búsqueda empieza en el nodo hint (un nodo del
+ * árbol cercano a la llave) y rebalancea subiendo por los padres. Con hint
+ * en el máximo, insertar un valor mayor compara una sola vez.
+ */
+template<class Node, class Key, class Compare, class KeyOf, class Make>
+inline int insert_hint(
+  Node          **root,
+  Node           *hint,
+  const Key      &key,
+  const Compare  &compare,
+  const KeyOf    &key_of,
+  Make            make,
+  Node          **found_node){
+
+    if (hint == nullptr || *root == nullptr){
+        return insert(root,key,compare,key_of,make,found_node);
+    }
+
+    // Descend from the subtree that holds the position of the key.
+    Node *subtree=finger(hint,key,compare,key_of);
+    Node *parent=subtree->parent;
+    Node **link=link_of(root,subtree);
+    int depth=0;
+    while (*link != nullptr){
+        parent=*link;
+        if (compare(key,key_of(*link))){
+            link=&((*link)->lc_node);
+        }
+        else if (compare(key_of(*link),key)){
+            link=&((*link)->rc_node);
+        }
+        else {
+            // Key already present.
+            AVL_STATS_DEPTH(depth);
+            *found_node=*link;
+            return AVL_SUCCESS;
+        }
+        depth++;
+    }
+    AVL_STATS_DEPTH(depth);
+
+    int status=make(link);
+    if (status!=AVL_SUCCESS){
+        return status;
+    }
+    (*link)->parent=parent;
+    *found_node=*link;
+    rebalance_up(root,parent);
+    return AVL_SUCCESS;
+}
+
+/**
+ * erase_node
+ * Quita del árbol un nodo dado sin liberarlo, subiendo por los padres. Un
+ * nodo con dos hijos se reemplaza por el mínimo de su subárbol derecho.
+ */
+template<class Node>
+inline void erase_node(
+  Node **root,
+  Node  *node){
+
+    Node **link=link_of(root,node);
+    Node *rebalance_from;
+
+    // A node with one child or none is replaced by that child.
+    if (node->rc_node == nullptr || node->lc_node == nullptr){
+        Node *child=(node->rc_node != nullptr) ? node->rc_node : node->lc_node;
+        *link=child;
+        if (child != nullptr){
+            child->parent=node->parent;
+        }
+        rebalance_from=node->parent;
+    }
+    else {
+        // Two children, move the right min to the place of the node.
+        Node *min_node=leftmost(node->rc_node);
+        if (min_node->parent == node){
+            rebalance_from=min_node;
+        }
+        else {
+            rebalance_from=min_node->parent;
+            rebalance_from->lc_node=min_node->rc_node;
+            if (min_node->rc_node != nullptr){
+                min_node->rc_node->parent=rebalance_from;
+            }
+            min_node->rc_node=node->rc_node;
+            node->rc_node->parent=min_node;
+        }
+        min_node->lc_node=node->lc_node;
+        node->lc_node->parent=min_node;
+        min_node->parent=node->parent;
+        min_node->height=node->height;
+        *link=min_node;
+    }
+    node->lc_node=nullptr;
+    node->rc_node=nullptr;
+    node->parent=nullptr;
+
+    rebalance_up(root,rebalance_from);
+}
+
+/**
+ * rank
+ * Cuenta las llaves estrictamente menores que key en O(log n) usando los
+ * tamaños de los subárboles.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline int rank(
+  const Node    *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    int smaller=0;
+    while (root != nullptr){
+        if (compare(key_of(root),key)){
+            // Node and its left subtree are smaller.
+            smaller+=size(root->lc_node)+1;
+            root=root->rc_node;
+        }
+        else {
+            root=root->lc_node;
+        }
+    }
+    return smaller;
+}
+
+/**
+ * select
+ * Retorna el nodo con la k-ésima menor llave (desde 0) en O(log n), o
+ * nullptr si k está fuera de rango.
+ */
+template<class Node>
+inline Node *select(
+  Node *root,
+  int   k){
+
+    if (k < 0 || k >= size(root)){
+        return nullptr;
+    }
+    while (root != nullptr){
+        int left_size=size(root->lc_node);
+        if (k < left_size){
+            root=root->lc_node;
+        }
+        else if (k > left_size){
+            k-=left_size+1;
+            root=root->rc_node;
+        }
+        else {
+            break;
+        }
+    }
+    return root;
+}
+
+/**
+ * lower_bound
+ * Retorna el nodo con la menor llave mayor o igual que key, o nullptr.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *lower_bound(
+  Node          *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    Node *bound=nullptr;
+    while (root != nullptr){
+        if (compare(key_of(root),key)){
+            root=root->rc_node;
+        }
+        else {
+            bound=root;
+            root=root->lc_node;
+        }
+    }
+    return bound;
+}
+
+/**
+ * upper_bound
+ * Retorna el nodo con la menor llave estrictamente mayor que key, o nullptr.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *upper_bound(
+  Node          *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    Node *bound=nullptr;
+    while (root != nullptr){
+        if (compare(key,key_of(root))){
+            bound=root;
+            root=root->lc_node;
+        }
+        else {
+            root=root->rc_node;
+        }
+    }
+    return bound;
+}
+
+/**
+ * floor
+ * Retorna el nodo con la mayor llave menor o igual que key, o nullptr.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *floor(
+  Node          *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of){
+
+    Node *bound=nullptr;
+    while (root != nullptr){
+        if (compare(key,key_of(root))){
+            root=root->lc_node;
+        }
+        else {
+            bound=root;
+            root=root->rc_node;
+        }
+    }
+    return bound;
+}
+
+/**
+ * range_scan
+ * Visita en orden los nodos con llave en [low, high) usando una pila acotada
+ * por la altura máxima. Solo se recorren el camino hacia low y los nodos del
+ * rango. Si visit(node) retorna un código distinto de AVL_SUCCESS, el
+ * recorrido se detiene y se retorna ese código.
+ */
+template<class Node, class Key, class Compare, class KeyOf, class Visit>
+inline int range_scan(
+  Node          *root,
+  const Key     &low,
+  const Key     &high,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Visit          visit){
+
+    Node *stack[AVL_MAX_HEIGHT];
+    int depth=0;
+
+    // Stack the nodes of the path to low that are inside the range.
+    while (root != nullptr){
+        if (compare(key_of(root),low)){
+            root=root->rc_node;
+        }
+        else {
+            stack[depth++]=root;
+            root=root->lc_node;
+        }
+    }
+
+    // Pop in order until a key reaches high.
+    while (depth > 0){
+        Node *node=stack[--depth];
+        if (!compare(key_of(node),high)){
+            break;
+        }
+        int status=visit(node);
+        if (status!=AVL_SUCCESS){
+            return status;
+        }
+
+        // Continue with the leftmost path of the right subtree.
+        for (Node *next=node->rc_node; next != nullptr; next=next->lc_node){
+            stack[depth++]=next;
+        }
+    }
+    return AVL_SUCCESS;
+}
+
+/**
+ * pre_order
+ * Visita los nodos en pre-orden (raíz, izquierda, derecha) con una pila
+ * acotada por la altura máxima. Un código distinto de AVL_SUCCESS detiene
+ * el recorrido.
+ */
+template<class Node, class Visit>
+inline int pre_order(
+  Node  *root,
+  Visit  visit){
+
+    if (root == nullptr){
+        return AVL_SUCCESS;
+    }
+    Node *stack[AVL_MAX_HEIGHT];
+    int depth=0;
+    stack[depth++]=root;
+    while (depth > 0){
+        Node *node=stack[--depth];
+        int status=visit(node);
+        if (status!=AVL_SUCCESS){
+            return status;
+        }
+
+        // Right goes first so left is popped first.
+        if (node->rc_node != nullptr){
+            stack[depth++]=node->rc_node;
+        }
+        if (node->lc_node != nullptr){
+            stack[depth++]=node->lc_node;
+        }
+    }
+    return AVL_SUCCESS;
+}
+
+/**
+ * in_order
+ * Visita los nodos en orden creciente con una pila acotada por la altura
+ * máxima.
+ */
+template<class Node, class Visit>
+inline int in_order(
+  Node  *root,
+  Visit  visit){
+
+    Node *stack[AVL_MAX_HEIGHT];
+    int depth=0;
+    while (root != nullptr || depth > 0){
+        // Stack the left spine, then visit its deepest node.
+        while (root != nullptr){
+            stack[depth++]=root;
+            root=root->lc_node;
+        }
+        Node *node=stack[--depth];
+        int status=visit(node);
+        if (status!=AVL_SUCCESS){
+            return status;
+        }
+        root=node->rc_node;
+    }
+    return AVL_SUCCESS;
+}
+
+/**
+ * level_order
+ * Visita los nodos por niveles, de izquierda a derecha. La cola crece hasta
+ * el ancho del último nivel, O(n) en el peor caso.
+ */
+template<class Node, class Visit>
+inline int level_order(
+  Node  *root,
+  Visit  visit){
+
+    if (root == nullptr){
+        return AVL_SUCCESS;
+    }
+    std::vector<Node *> queue;
+    queue.push_back(root);
+    for (size_t head = 0; head < queue.size(); head++){
+        Node *node=queue[head];
+        int status=visit(node);
+        if (status!=AVL_SUCCESS){
+            return status;
+        }
+        if (node->lc_node != nullptr){
+            queue.push_back(node->lc_node);
+        }
+        if (node->rc_node != nullptr){
+            queue.push_back(node->rc_node);
+        }
+    }
+    return AVL_SUCCESS;
+}
+
+/**
+ * morris
+ * Recorrido de Morris con O(1) memoria extra: enlaza temporalmente el
+ * predecesor de cada nodo con el nodo para poder volver sin pila. En
+ * pre-orden (pre=true) o en orden. Los enlaces se restauran aunque visit
+ * detenga el recorrido, así que visit no debe leer los hijos ni modificar
+ * el árbol.
+ */
+template<class Node, class Visit>
+inline int morris(
+  Node  *root,
+  bool   pre,
+  Visit  visit){
+
+    int status=AVL_SUCCESS;
+    Node *current=root;
+    while (current != nullptr){
+        if (current->lc_node == nullptr){
+            if (status==AVL_SUCCESS){
+                status=visit(current);
+            }
+            current=current->rc_node;
+            continue;
+        }
+
+        // Rightmost node of the left subtree, or the thread back to current.
+        Node *predecessor=current->lc_node;
+        while (predecessor->rc_node != nullptr && predecessor->rc_node != current){
+            predecessor=predecessor->rc_node;
+        }
+
+        if (predecessor->rc_node == nullptr){
+            // First time here: thread back and go left.
+            if (pre && status==AVL_SUCCESS){
+                status=visit(current);
+            }
+            predecessor->rc_node=current;
+            current=current->lc_node;
+        }
+        else {
+            // Back from the left subtree: remove the thread and go right.
+            predecessor->rc_node=nullptr;
+            if (!pre && status==AVL_SUCCESS){
+                status=visit(current);
+            }
+            current=current->rc_node;
+        }
+    }
+    return status;
+}
+
+/**
+ * rebalance_all
+ * Rebalancea todos los enlaces de un camino, del más profundo a la raíz.
+ */
+template<class Node>
+inline void rebalance_all(
+  Node ***path,
+  int     depth){
+    for (int index = depth-1; index >= 0; index--){
+        rebalance_node(path[index]);
+    }
+}
+
+/**
+ * join
+ * Une dos árboles AVL con un nodo intermedio, donde todas las llaves de left
+ * son menores que la de mid y todas las de right son mayores. Desciende por
+ * el borde del árbol más alto hasta la altura del otro, así que cuesta
+ * O(|h(left)-h(right)|+1). Retorna la nueva raíz.
+ */
+template<class Node>
+inline Node *join(
+  Node *left,
+  Node *mid,
+  Node *right){
+
+    Node **path[AVL_MAX_HEIGHT];
+    int depth=0;
+    int left_height=height(left);
+    int right_height=height(right);
+
+    // Both trees become standalone roots.
+    if (left != nullptr){
+        left->parent=nullptr;
+    }
+    if (right != nullptr){
+        right->parent=nullptr;
+    }
+
+    // Heights close enough, mid becomes the root.
+    if (left_height <= right_height+1 && right_height <= left_height+1){
+        mid->lc_node=left;
+        mid->rc_node=right;
+        mid->parent=nullptr;
+        adopt(mid);
+        return mid;
+    }
+
+    Node *root;
+    Node **link;
+    if (left_height > right_height){
+        // Follow the right spine of left down to the height of right.
+        root=left;
+        link=&root;
+        while (height(*link) > right_height+1){
+            path[depth++]=link;
+            link=&((*link)->rc_node);
+        }
+        mid->lc_node=*link;
+        mid->rc_node=right;
+    }
+    else {
+        // Follow the left spine of right down to the height of left.
+        root=right;
+        link=&root;
+        while (height(*link) > left_height+1){
+            path[depth++]=link;
+            link=&((*link)->lc_node);
+        }
+        mid->lc_node=left;
+        mid->rc_node=*link;
+    }
+
+    // Hang mid in place of the spine node and rebalance up to the root.
+    mid->parent=*path[depth-1];
+    adopt(mid);
+    *link=mid;
+    rebalance_all(path,depth);
+    root->parent=nullptr;
+    return root;
+}
+
+/**
+ * unlink_last
+ * Quita el nodo de mayor llave del árbol y lo retorna (nullptr si el árbol
+ * está vacío), rebalanceando el borde derecho.
+ */
+template<class Node>
+inline Node *unlink_last(
+  Node **root){
+
+    Node **path[AVL_MAX_HEIGHT];
+    int depth=0;
+    Node **link=root;
+
+    if (*root == nullptr){
+        return nullptr;
+    }
+
+    // Follow the right spine.
+    while ((*link)->rc_node != nullptr){
+        path[depth++]=link;
+        link=&((*link)->rc_node);
+    }
+
+    // Its left child (if any) takes its place.
+    Node *last=*link;
+    *link=last->lc_node;
+    if (*link != nullptr){
+        (*link)->parent=last->parent;
+    }
+    last->lc_node=nullptr;
+    last->parent=nullptr;
+    rebalance_all(path,depth);
+    return last;
+}
+
+/**
+ * join2
+ * Une dos árboles donde todas las llaves de left son menores que las de
+ * right, usando el máximo de left como nodo intermedio.
+ */
+template<class Node>
+inline Node *join2(
+  Node *left,
+  Node *right){
+
+    if (left == nullptr){
+        if (right != nullptr){
+            right->parent=nullptr;
+        }
+        return right;
+    }
+    Node *mid=unlink_last(&left);
+    return join(left,mid,right);
+}
+
+/**
+ * split
+ * Divide el árbol en las llaves menores que key (left) y las mayores (right)
+ * en O(log n). Retorna el nodo con la llave igual a key, ya desenlazado, o
+ * nullptr si no existe. El árbol original deja de existir.
+ */
+template<class Node, class Key, class Compare, class KeyOf>
+inline Node *split(
+  Node          *root,
+  const Key     &key,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Node         **left,
+  Node         **right){
+
+    Node *path[AVL_MAX_HEIGHT];
+    bool went_left[AVL_MAX_HEIGHT];
+    int depth=0;
+    Node *found=nullptr;
+
+    // Descend to the key recording the nodes passed.
+    while (root != nullptr){
+        if (compare(key,key_of(root))){
+            went_left[depth]=true;
+            path[depth++]=root;
+            root=root->lc_node;
+        }
+        else if (compare(key_of(root),key)){
+            went_left[depth]=false;
+            path[depth++]=root;
+            root=root->rc_node;
+        }
+        else {
+            found=root;
+            break;
+        }
+    }
+
+    // The matching node (if any) hands over its subtrees.
+    Node *left_tree=nullptr;
+    Node *right_tree=nullptr;
+    if (found != nullptr){
+        left_tree=found->lc_node;
+        right_tree=found->rc_node;
+        found->lc_node=nullptr;
+        found->rc_node=nullptr;
+        found->parent=nullptr;
+        update(found);
+    }
+
+    // Going back up, each node joins the side it was not descended into.
+    for (int index = depth-1; index >= 0; index--){
+        Node *node=path[index];
+        if (went_left[index]){
+            right_tree=join(right_tree,node,node->rc_node);
+        }
+        else {
+            left_tree=join(node->lc_node,node,left_tree);
+        }
+    }
+
+    // A side that was never joined is still a child of found or of a path
+    // node.
+    if (left_tree != nullptr){
+        left_tree->parent=nullptr;
+    }
+    if (right_tree != nullptr){
+        right_tree->parent=nullptr;
+    }
+    *left=left_tree;
+    *right=right_tree;
+    return found;
+}
+
+/**
+ * build
+ * Construye un árbol perfectamente balanceado con las posiciones
+ * [first, last) de una lista ordenada, de abajo hacia arriba y sin
+ * rotaciones. make(index) crea el nodo de la posición index.
+ */
+template<class Node, class Make>
+inline Node *build(
+  int   first,
+  int   last,
+  Make &make){
+
+    // Empty range, no subtree.
+    if (first >= last){
+        return nullptr;
+    }
+
+    // Middle element becomes the root, halves become the children.
+    int middle=first+(last-first)/2;
+    Node *root=make(middle);
+    root->lc_node=build<Node>(first,middle,make);
+    root->rc_node=build<Node>(middle+1,last,make);
+    root->parent=nullptr;
+    adopt(root);
+    return root;
+}
+
+/**
+ * insert_sorted
+ * Inserta un lote de llaves ordenadas y sin repetidos keys[first, last) en
+ * una sola pasada: el lote se divide en cada nodo entre sus dos subárboles y
+ * cada subárbol afectado se rebalancea una vez con join. Los subárboles
+ * vacíos reciben el resto del lote construido directamente. make(index) crea
+ * el nodo de la posición index. Retorna la nueva raíz.
+ */
+template<class Node, class Key, class Compare, class KeyOf, class Make>
+inline Node *insert_sorted(
+  Node          *root,
+  const Key     *keys,
+  int            first,
+  int            last,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Make          &make){
+
+    // Nothing left to insert here.
+    if (first >= last){
+        return root;
+    }
+
+    // Empty subtree, build the rest of the batch.
+    if (root == nullptr){
+        return build<Node>(first,last,make);
+    }
+
+    // Split the batch around the node key, skipping a repeated one.
+    const Key *split_point=std::lower_bound(keys+first,keys+last,key_of(root),
+                                            compare);
+    int middle=static_cast<int>(split_point-keys);
+    int next=middle;
+    if (next < last && !compare(key_of(root),keys[next])){
+        next++;
+    }
+
+    // Push each part down its side, then join both sides once.
+    Node *left=insert_sorted(root->lc_node,keys,first,middle,compare,key_of,make);
+    Node *right=insert_sorted(root->rc_node,keys,next,last,compare,key_of,make);
+    return join(left,root,right);
+}
+
+/**
+ * erase_sorted
+ * Elimina un lote de llaves ordenadas y sin repetidos keys[first, last) en
+ * una sola pasada, dividiendo el lote en cada nodo. Cada nodo eliminado se
+ * entrega a release(node) y *removed cuenta los nodos eliminados.
+ * Retorna la nueva raíz.
+ */
+template<class Node, class Key, class Compare, class KeyOf, class Release>
+inline Node *erase_sorted(
+  Node          *root,
+  const Key     *keys,
+  int            first,
+  int            last,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Release       &release,
+  int           *removed){
+
+    // Nothing to remove here.
+    if (first >= last || root == nullptr){
+        return root;
+    }
+
+    // Split the batch around the node key.
+    const Key *split_point=std::lower_bound(keys+first,keys+last,key_of(root),
+                                            compare);
+    int middle=static_cast<int>(split_point-keys);
+    int next=middle;
+    bool matched=(next < last && !compare(key_of(root),keys[next]));
+    if (matched){
+        next++;
+    }
+
+    // Remove from each side, then join them back with or without the node.
+    Node *left=erase_sorted(root->lc_node,keys,first,middle,compare,key_of,
+                            release,removed);
+    Node *right=erase_sorted(root->rc_node,keys,next,last,compare,key_of,
+                             release,removed);
+    if (matched){
+        root->lc_node=nullptr;
+        root->rc_node=nullptr;
+        root->parent=nullptr;
+        release(root);
+        (*removed)++;
+        return join2(left,right);
+    }
+    return join(left,root,right);
+}
+
+/**
+ * destroy
+ * Libera todos los nodos del subárbol con free_node(node), aplanándolo con
+ * rotaciones para no usar recursión ni memoria extra.
+ */
+template<class Node, class Free>
+inline void destroy(
+  Node *root,
+  Free  free_node){
+    while (root != nullptr){
+        if (root->lc_node != nullptr){
+            Node *lc=root->lc_node;
+            root->lc_node=lc->rc_node;
+            lc->rc_node=root;
+            root=lc;
+        }
+        else {
+            Node *rc=root->rc_node;
+            free_node(root);
+            root=rc;
+        }
+    }
+}
+
+/**
+ * spawn_depth
+ * Niveles de recursión en que se pueden crear hilos para usar hasta
+ * thread_count hilos en total (cada nivel duplica los hilos).
+ */
+inline int spawn_depth(
+  int thread_count){
+    int depth=0;
+    while (thread_count > 1){
+        thread_count=(thread_count+1)/2;
+        depth++;
+    }
+    return depth;
+}
+
+/**
+ * fork_join
+ * Ejecuta left_task y right_task, el primero en otro hilo si quedan niveles
+ * para crear hilos y ambos lados son grandes.
+ */
+template<class Left, class Right>
+inline void fork_join(
+  bool   parallel,
+  Left  &left_task,
+  Right &right_task){
+    if (parallel){
+        std::future<void> pending=std::async(std::launch::async,
+                                             [&left_task](){ left_task(); });
+        right_task();
+        pending.get();
+    }
+    else {
+        left_task();
+        right_task();
+    }
+}
+
+/**
+ * set_union
+ * Unión basada en join: divide second con la llave de la raíz de first y une
+ * recursivamente las mitades, en O(m log(n/m + 1)) para m <= n. Ambos
+ * árboles se consumen; los nodos repetidos de second se entregan a release.
+ * Los dos lados se resuelven en paralelo mientras spawn > 0.
+ */
+template<class Node, class Compare, class KeyOf, class Release>
+inline Node *set_union(
+  Node          *first,
+  Node          *second,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Release       &release,
+  int            spawn){
+
+    if (first == nullptr){
+        if (second != nullptr){
+            second->parent=nullptr;
+        }
+        return second;
+    }
+    if (second == nullptr){
+        first->parent=nullptr;
+        return first;
+    }
+
+    // Split second around the root of first.
+    Node *second_left;
+    Node *second_right;
+    Node *repeated=split(second,key_of(first),compare,key_of,&second_left,
+                         &second_right);
+    if (repeated != nullptr){
+        release(repeated);
+    }
+
+    // Merge both halves, possibly in parallel.
+    Node *first_left=first->lc_node;
+    Node *first_right=first->rc_node;
+    Node *left;
+    Node *right;
+    auto left_task=[&](){
+        left=set_union(first_left,second_left,compare,key_of,release,spawn-1);
+    };
+    auto right_task=[&](){
+        right=set_union(first_right,second_right,compare,key_of,release,spawn-1);
+    };
+    fork_join(spawn > 0 && size(first) >= AVL_PARALLEL_GRAIN &&
+              size(second_left)+size(second_right) >= AVL_PARALLEL_GRAIN,
+              left_task,right_task);
+    return join(left,first,right);
+}
+
+/**
+ * set_intersection
+ * Intersección basada en join: conserva los nodos de first cuyas llaves
+ * también están en second. Ambos árboles se consumen y los nodos descartados
+ * se entregan a release.
+ */
+template<class Node, class Compare, class KeyOf, class Release>
+inline Node *set_intersection(
+  Node          *first,
+  Node          *second,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Release       &release,
+  int            spawn){
+
+    // Nothing in common with an empty tree.
+    if (first == nullptr || second == nullptr){
+        destroy(first,release);
+        destroy(second,release);
+        return nullptr;
+    }
+
+    // Split second around the root of first.
+    Node *second_left;
+    Node *second_right;
+    Node *repeated=split(second,key_of(first),compare,key_of,&second_left,
+                         &second_right);
+
+    // Intersect both halves, possibly in parallel.
+    Node *first_left=first->lc_node;
+    Node *first_right=first->rc_node;
+    Node *left;
+    Node *right;
+    auto left_task=[&](){
+        left=set_intersection(first_left,second_left,compare,key_of,release,
+                              spawn-1);
+    };
+    auto right_task=[&](){
+        right=set_intersection(first_right,second_right,compare,key_of,release,
+                               spawn-1);
+    };
+    fork_join(spawn > 0 && size(first) >= AVL_PARALLEL_GRAIN &&
+              size(second_left)+size(second_right) >= AVL_PARALLEL_GRAIN,
+              left_task,right_task);
+
+    // Keep the root of first only if second had it too.
+    if (repeated != nullptr){
+        release(repeated);
+        return join(left,first,right);
+    }
+    first->lc_node=nullptr;
+    first->rc_node=nullptr;
+    release(first);
+    return join2(left,right);
+}
+
+/**
+ * set_difference
+ * Diferencia basada en join: conserva los nodos de first cuyas llaves no
+ * están en second. Ambos árboles se consumen y los nodos descartados se
+ * entregan a release.
+ */
+template<class Node, class Compare, class KeyOf, class Release>
+inline Node *set_difference(
+  Node          *first,
+  Node          *second,
+  const Compare &compare,
+  const KeyOf   &key_of,
+  Release       &release,
+  int            spawn){
+
+    if (first == nullptr){
+        destroy(second,release);
+        return nullptr;
+    }
+    if (second == nullptr){
+        first->parent=nullptr;
+        return first;
+    }
+
+    // Split first around the root of second.
+    Node *first_left;
+    Node *first_right;
+    Node *repeated=split(first,key_of(second),compare,key_of,&first_left,
+                         &first_right);
+    if (repeated != nullptr){
+        release(repeated);
+    }
+
+    // Subtract both halves, possibly in parallel.
+    Node *second_left=second->lc_node;
+    Node *second_right=second->rc_node;
+    Node *left;
+    Node *right;
+    auto left_task=[&](){
+        left=set_difference(first_left,second_left,compare,key_of,release,
+                            spawn-1);
+    };
+    auto right_task=[&](){
+        right=set_difference(first_right,second_right,compare,key_of,release,
+                             spawn-1);
+    };
+    fork_join(spawn > 0 && size(second) >= AVL_PARALLEL_GRAIN &&
+              size(first_left)+size(first_right) >= AVL_PARALLEL_GRAIN,
+              left_task,right_task);
+
+    // The root of second is never part of the result.
+    second->lc_node=nullptr;
+    second->rc_node=nullptr;
+    release(second);
+    return join2(left,right);
+}
+
+/**
+ * build_parallel
+ * Igual que build, pero mientras spawn > 0 construye los dos subárboles de
+ * cada nivel en hilos distintos. make(index) debe poder llamarse desde
+ * varios hilos a la vez.
+ */
+template<class Node, class Make>
+inline Node *build_parallel(
+  int   first,
+  int   last,
+  Make &make,
+  int   spawn){
+
+    // Small ranges or no more threads, build sequentially.
+    if (spawn <= 0 || last-first < AVL_PARALLEL_GRAIN){
+        return build<Node>(first,last,make);
+    }
+
+    // Both halves are disjoint subtrees, build them concurrently.
+    int middle=first+(last-first)/2;
+    Node *left;
+    Node *right;
+    auto left_task=[&](){
+        left=build_parallel<Node>(first,middle,make,spawn-1);
+    };
+    auto right_task=[&](){
+        right=build_parallel<Node>(middle+1,last,make,spawn-1);
+    };
+    fork_join(true,left_task,right_task);
+
+    // Join them under the middle element.
+    Node *root=make(middle);
+    root->lc_node=left;
+    root->rc_node=right;
+    root->parent=nullptr;
+    adopt(root);
+    return root;
+}
+
+} /* namespace avl_detail */
+
+
+/**
+ * Struct que define un nodo genérico con llave y carga asociada
+ */
+template<class Key, class Value>
+struct avl_tree_node {
+  /** Puntero al nodo hijo izquierdo */
+  avl_tree_node *lc_node;
+
+  /** Puntero al nodo hijo derecho */
+  avl_tree_node *rc_node;
+
+  /** Puntero al nodo padre (nullptr en la raíz) */
+  avl_tree_node *parent;
+
+  /** Altura del subárbol cuya raíz es este nodo */
+  int height;
+
+  /** Cantidad de nodos del subárbol cuya raíz es este nodo */
+  int size;
+
+  /** Llave del nodo */
+  Key key;
+
+  /** Carga asociada a la llave */
+  Value value;
+
+  /** Construye una hoja a partir de la llave y los argumentos de la carga */
+  template<class K, class... Args>
+  explicit avl_tree_node(
+    K &&in_key,
+    Args &&...args)
+    : lc_node(nullptr), rc_node(nullptr), parent(nullptr), height(1), size(1),
+      key(std::forward<K>(in_key)), value(std::forward<Args>(args)...){
+  }
+};
+
+/**
+ * Functor que obtiene la llave de un avl_tree_node
+ */
+struct avl_tree_key {
+  template<class Key, class Value>
+  const Key &operator()(
+    const avl_tree_node<Key,Value> *node) const{
+      return node->key;
+  }
+};
+
+/**
+ * Struct que define una cadena de tamaño fijo usable como llave, comparada
+ * byte a byte sin reservar memoria.
+ */
+template<std::size_t N>
+struct avl_fixed_string {
+  /** Caracteres de la cadena, rellenados con ceros */
+  char data[N];
+
+  avl_fixed_string(){
+    std::memset(data,0,N);
+  }
+
+  /** Copia hasta N caracteres de una cadena terminada en cero */
+  avl_fixed_string(
+    const char *text){
+      std::memset(data,0,N);
+      std::strncpy(data,text,N);
+  }
+
+  bool operator<(
+    const avl_fixed_string &other) const{
+      return std::memcmp(data,other.data,N) < 0;
+  }
+
+  bool operator>(
+    const avl_fixed_string &other) const{
+      return std::memcmp(data,other.data,N) > 0;
+  }
+
+  bool operator==(
+    const avl_fixed_string &other) const{
+      return std::memcmp(data,other.data,N) == 0;
+  }
+};
+
+/**
+ * Clase que define un árbol AVL genérico de llaves Key con carga Value.
+ * El comparador se resuelve en tiempo de compilación y los nodos se reservan
+ * con Allocator (re-enlazado al tipo de nodo). Las llaves repetidas se
+ * ignoran, igual que en avl_node_add.
+ */
+template<class Key,
+         class Value,
+         class Compare = std::less<Key>,
+         class Allocator = std::allocator<std::pair<const Key, Value> > >
+class avl_tree {
+public:
+  typedef avl_tree_node<Key,Value> node_type;
+  typedef typename std::allocator_traits<Allocator>::template
+          rebind_alloc<node_type> node_allocator;
+  typedef std::allocator_traits<node_allocator> node_traits;
+
+  explicit avl_tree(
+    const Compare   &compare = Compare(),
+    const Allocator &allocator = Allocator())
+    : root_node(nullptr), node_count(0), compare(compare),
+      allocator(allocator){
+  }
+
+  avl_tree(
+    avl_tree &&other)
+    : root_node(other.root_node), node_count(other.node_count),
+      compare(std::move(other.compare)), allocator(std::move(other.allocator)){
+      other.root_node=nullptr;
+      other.node_count=0;
+  }
+
+  avl_tree &operator=(
+    avl_tree &&other){
+      if (this != &other){
+        clear();
+        std::swap(root_node,other.root_node);
+        std::swap(node_count,other.node_count);
+        compare=std::move(other.compare);
+        allocator=std::move(other.allocator);
+      }
+      return *this;
+  }
+
+  /**
+   * Iterador bidireccional en orden. Sigue válido mientras su nodo no sea
+   * eliminado, aunque se inserten o eliminen otras llaves.
+   */
+  class iterator {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef node_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef node_type *pointer;
+    typedef node_type &reference;
+
+    iterator()
+      : node(nullptr), owner(nullptr){
+    }
+
+    iterator(
+      node_type      *node,
+      const avl_tree *owner)
+      : node(node), owner(owner){
+    }
+
+    reference operator*() const{
+      return *node;
+    }
+
+    pointer operator->() const{
+      return node;
+    }
+
+    iterator &operator++(){
+      node=avl_detail::next(node);
+      return *this;
+    }
+
+    iterator operator++(int){
+      iterator old=*this;
+      ++(*this);
+      return old;
+    }
+
+    // Going back from end() lands on the greatest key.
+    iterator &operator--(){
+      node=(node == nullptr) ? avl_detail::rightmost(owner->root_node) :
+                               avl_detail::prev(node);
+      return *this;
+    }
+
+    iterator operator--(int){
+      iterator old=*this;
+      --(*this);
+      return old;
+    }
+
+    bool operator==(
+      const iterator &other) const{
+        return node == other.node;
+    }
+
+    bool operator!=(
+      const iterator &other) const{
+        return node != other.node;
+    }
+
+  private:
+    node_type      *node;
+    const avl_tree *owner;
+  };
+
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+
+  /** Iterador a la menor llave */
+  iterator begin() const{
+    return iterator(avl_detail::leftmost(root_node),this);
+  }
+
+  /** Iterador después de la mayor llave */
+  iterator end() const{
+    return iterator(nullptr,this);
+  }
+
+  /** Iterador inverso a la mayor llave */
+  reverse_iterator rbegin() const{
+    return reverse_iterator(end());
+  }
+
+  /** Iterador inverso antes de la menor llave */
+  reverse_iterator rend() const{
+    return reverse_iterator(begin());
+  }
+
+  avl_tree(const avl_tree &)=delete;
+  avl_tree &operator=(const avl_tree &)=delete;
+
+  ~avl_tree(){
+    clear();
+  }
+
+  /**
+   * insert
+   * Inserta una copia de la llave y la carga. Las llaves repetidas se ignoran.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int insert(
+    const Key   &key,
+    const Value &value){
+      return emplace(key,value);
+  }
+
+  /**
+   * insert
+   * Inserta la llave y la carga moviéndolas al nodo, solo si la llave no
+   * existía.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int insert(
+    Key   &&key,
+    Value &&value){
+      node_type *found;
+      return avl_detail::insert(&root_node,key,compare,avl_tree_key(),
+        [&](node_type **link) -> int {
+          *link=create_node(std::move(key),std::move(value));
+          return AVL_SUCCESS;
+        },&found);
+  }
+
+  /**
+   * emplace
+   * Construye el nodo en su lugar a partir de la llave y los argumentos de la
+   * carga. Si la llave ya existía, la carga no se construye.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  template<class K, class... Args>
+  int emplace(
+    K       &&key,
+    Args &&...args){
+      node_type *found;
+      const Key &lookup=key;
+      return avl_detail::insert(&root_node,lookup,compare,avl_tree_key(),
+        [&](node_type **link) -> int {
+          *link=create_node(std::forward<K>(key),std::forward<Args>(args)...);
+          return AVL_SUCCESS;
+        },&found);
+  }
+
+  /**
+   * erase
+   * Elimina la llave del árbol. Retorna AVL_NOT_FOUND si el árbol está vacío
+   * y AVL_OUT_OF_RANGE si la llave no existe.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int erase(
+    const Key &key){
+      node_type *removed;
+      int status=avl_detail::unlink(&root_node,key,compare,avl_tree_key(),
+                                    &removed);
+      if (status==AVL_SUCCESS){
+        destroy_node(removed);
+      }
+      return status;
+  }
+
+  /**
+   * search
+   * Busca la llave y devuelve el nodo que la contiene.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int search(
+    const Key  &key,
+    node_type **found_node) const{
+      if (root_node == nullptr){
+        return AVL_NOT_FOUND;
+      }
+      node_type *node=avl_detail::find(root_node,key,compare,avl_tree_key());
+      if (node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      *found_node=node;
+      return AVL_SUCCESS;
+  }
+
+  /**
+   * find
+   * Retorna un puntero a la carga de la llave, o nullptr si no existe.
+   */
+  Value *find(
+    const Key &key) const{
+      node_type *node=avl_detail::find(root_node,key,compare,avl_tree_key());
+      return (node == nullptr) ? nullptr : &(node->value);
+  }
+
+  /**
+   * min_get
+   * Obtiene el nodo con la menor llave.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int min_get(
+    node_type **min_node) const{
+      if (root_node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      *min_node=avl_detail::leftmost(root_node);
+      return AVL_SUCCESS;
+  }
+
+  /**
+   * max_get
+   * Obtiene el nodo con la mayor llave.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int max_get(
+    node_type **max_node) const{
+      if (root_node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      *max_node=avl_detail::rightmost(root_node);
+      return AVL_SUCCESS;
+  }
+
+  /**
+   * rank
+   * Cantidad de llaves estrictamente menores que key, en O(log n).
+   */
+  int rank(
+    const Key &key) const{
+      return avl_detail::rank(root_node,key,compare,avl_tree_key());
+  }
+
+  /**
+   * select
+   * Obtiene el nodo con la k-ésima menor llave (desde 0), en O(log n).
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int select(
+    int         k,
+    node_type **found_node) const{
+      node_type *node=avl_detail::select(root_node,k);
+      if (node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      *found_node=node;
+      return AVL_SUCCESS;
+  }
+
+  /**
+   * lower_bound
+   * Obtiene el nodo con la menor llave mayor o igual que key.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int lower_bound(
+    const Key  &key,
+    node_type **found_node) const{
+      return bound_status(avl_detail::lower_bound(root_node,key,compare,
+                                                  avl_tree_key()),found_node);
+  }
+
+  /**
+   * upper_bound
+   * Obtiene el nodo con la menor llave estrictamente mayor que key.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int upper_bound(
+    const Key  &key,
+    node_type **found_node) const{
+      return bound_status(avl_detail::upper_bound(root_node,key,compare,
+                                                  avl_tree_key()),found_node);
+  }
+
+  /**
+   * floor
+   * Obtiene el nodo con la mayor llave menor o igual que key.
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  int floor(
+    const Key  &key,
+    node_type **found_node) const{
+      return bound_status(avl_detail::floor(root_node,key,compare,
+                                            avl_tree_key()),found_node);
+  }
+
+  /**
+   * range_count
+   * Cantidad de llaves en [low, high), en O(log n).
+   */
+  int range_count(
+    const Key &low,
+    const Key &high) const{
+      int count=rank(high)-rank(low);
+      return (count > 0) ? count : 0;
+  }
+
+  /**
+   * range_scan
+   * Visita en orden los nodos con llave en [low, high) con visit(node).
+   *
+   * @returns error_code Código de error indicando el éxito o error.
+   */
+  template<class Visit>
+  int range_scan(
+    const Key &low,
+    const Key &high,
+    Visit      visit) const{
+      return avl_detail::range_scan(root_node,low,high,compare,avl_tree_key(),
+                                    visit);
+  }
+
+  /** Libera todos los nodos del árbol */
+  void clear(){
+    avl_detail::destroy(root_node,[this](node_type *node){
+      destroy_node(node);
+    });
+    root_node=nullptr;
+    node_count=0;
+  }
+
+  /** Nodo raíz del árbol (nullptr si está vacío) */
+  node_type *root() const{
+    return root_node;
+  }
+
+  /** Cantidad de llaves en el árbol */
+  std::size_t size() const{
+    return node_count;
+  }
+
+  /** Indica si el árbol está vacío */
+  bool empty() const{
+    return node_count == 0;
+  }
+
+private:
+  int bound_status(
+    node_type  *node,
+    node_type **found_node) const{
+      if (root_node == nullptr){
+        return AVL_NOT_FOUND;
+      }
+      if (node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      *found_node=node;
+      return AVL_SUCCESS;
+  }
+
+  template<class... Args>
+  node_type *create_node(
+    Args &&...args){
+      node_type *node=node_traits::allocate(allocator,1);
+      try {
+        node_traits::construct(allocator,node,std::forward<Args>(args)...);
+      }
+      catch (...){
+        node_traits::deallocate(allocator,node,1);
+        throw;
+      }
+      node_count++;
+      return node;
+  }
+
+  void destroy_node(
+    node_type *node){
+      node_traits::destroy(allocator,node);
+      node_traits::deallocate(allocator,node,1);
+      node_count--;
+  }
+
+  node_type     *root_node;
+  std::size_t    node_count;
+  Compare        compare;
+  node_allocator allocator;
+};
+
+
+#endif /* AVL_GENERIC_H */
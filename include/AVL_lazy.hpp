@@ -0,0 +1,181 @@
+#ifndef AVL_LAZY_H
+#define AVL_LAZY_H
+
+#include "AVL_tree.hpp"
+
+/** Proporción de nodos eliminados por defecto (ej. para avl_lazy_init) */
+#define AVL_LAZY_DEFAULT_RATIO 0.25f
+
+/**
+ * Struct que define un árbol con eliminación diferida. Eliminar un número
+ * solo deja su nodo con count en 0 (un nodo eliminado), sin rotaciones; las
+ * búsquedas, el mínimo, el máximo y los recorridos lo saltean. Como el total
+ * de cada subárbol no cuenta los nodos eliminados, avl_multi_size,
+ * avl_multi_rank y avl_multi_select sobre root también los ignoran.
+ *
+ * Las eliminaciones nunca reestructuran el árbol. Cuando los nodos
+ * eliminados superan max_ratio de los nodos del árbol, la siguiente
+ * inserción lo reconstruye con avl_lazy_compact; como eso ocurre después de
+ * al menos max_ratio*n eliminaciones, el costo O(n) se amortiza en O(1) por
+ * eliminación. Para sacar ese costo de las inserciones, se puede llamar a
+ * avl_lazy_compact antes, por ejemplo en momentos sin carga.
+ */
+struct avl_lazy_tree {
+  /** Raíz del árbol, incluidos los nodos eliminados */
+  struct avl_node *root;
+
+  /** Pool de nodos del árbol */
+  struct avl_pool pool;
+
+  /** Cantidad de nodos eliminados que siguen en el árbol */
+  int tombstones;
+
+  /** Proporción de nodos eliminados a partir de la cual se desenlazan */
+  float max_ratio;
+};
+
+
+/**
+ * avl_lazy_init
+ * Inicializa un árbol vacío con eliminación diferida.
+ *
+ * @param [out] tree       Puntero al árbol.
+ * @param [in]  max_ratio  Proporción de nodos eliminados tolerada, en (0, 1]
+ *                         (ej. AVL_LAZY_DEFAULT_RATIO).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_lazy_init(
+  struct avl_lazy_tree *tree,
+  float                 max_ratio);
+
+/**
+ * avl_lazy_free
+ * Libera todos los nodos del árbol, eliminados o no.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ */
+void avl_lazy_free(
+  struct avl_lazy_tree *tree);
+
+/**
+ * avl_lazy_add
+ * Inserta un número en el árbol. Si su nodo estaba eliminado, lo recupera
+ * sin crear otro. Si los nodos eliminados superan max_ratio, primero
+ * compacta el árbol.
+ *
+ * @param [in]     num   Número por insertar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_add(
+  float                 num,
+  struct avl_lazy_tree *tree);
+
+/**
+ * avl_lazy_remove
+ * Marca como eliminado el nodo de un número en O(log n), sin rotaciones ni
+ * liberar memoria. Da error si el número no pertenece al árbol.
+ *
+ * @param [in]     num   Número por eliminar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_remove(
+  float                 num,
+  struct avl_lazy_tree *tree);
+
+/**
+ * avl_lazy_search
+ * Busca un número que no esté eliminado.
+ *
+ * @param [in]  num        Número por buscar.
+ * @param [in]  tree       Puntero al árbol.
+ * @param [out] found_node Puntero al nodo encontrado.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_search(
+  float                  num,
+  struct avl_lazy_tree  *tree,
+  struct avl_node      **found_node);
+
+/**
+ * avl_lazy_min_get
+ * Obtiene el menor valor no eliminado, bajando por los totales en O(log n).
+ *
+ * @param [in]  tree       Puntero al árbol.
+ * @param [out] min_value  Valor mínimo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_min_get(
+  struct avl_lazy_tree *tree,
+  float                *min_value);
+
+/**
+ * avl_lazy_max_get
+ * Obtiene el mayor valor no eliminado, bajando por los totales en O(log n).
+ *
+ * @param [in]  tree       Puntero al árbol.
+ * @param [out] max_value  Valor máximo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_max_get(
+  struct avl_lazy_tree *tree,
+  float                *max_value);
+
+/**
+ * avl_lazy_size
+ * Retorna la cantidad de números no eliminados del árbol.
+ *
+ * @param [in]  tree  Puntero al árbol.
+ *
+ * @returns size  cantidad de números
+ */
+int avl_lazy_size(
+  struct avl_lazy_tree *tree);
+
+/**
+ * avl_lazy_range_scan
+ * Visita en orden creciente los nodos no eliminados con valor en
+ * [low, high).
+ *
+ * @param [in]  tree     Puntero al árbol.
+ * @param [in]  low      límite inferior (incluido)
+ * @param [in]  high     límite superior (excluido)
+ * @param [in]  visit    función llamada con cada nodo del intervalo
+ * @param [in]  context  puntero del usuario entregado a visit
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lazy_range_scan(
+  struct avl_lazy_tree *tree,
+  float                 low,
+  float                 high,
+  avl_visitor           visit,
+  void                 *context);
+
+/**
+ * avl_lazy_compact
+ * Quita todos los nodos eliminados y reconstruye el árbol balanceado con los
+ * nodos restantes en O(n), sin reservar nodos nuevos.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_lazy_compact(
+  struct avl_lazy_tree *tree);
+
+
+#endif /* AVL_LAZY_H */
@@ -0,0 +1,192 @@
+#ifndef AVL_MAPPED_H
+#define AVL_MAPPED_H
+
+#include <cstddef>
+#include <cstdint>
+#include "AVL_compact.hpp"
+
+/** Identificador al inicio de todo archivo de árbol */
+#define AVL_MAPPED_MAGIC "AVLTREE"
+
+/** Versión del formato escrita por avl_mapped_write */
+#define AVL_MAPPED_VERSION 1
+
+/**
+ * Encabezado del archivo (32 bytes), seguido por count nodos compactos en
+ * orden creciente de valor. Los hijos se guardan como índices dentro de ese
+ * arreglo, así que el archivo no depende de la dirección donde se mapea.
+ */
+struct avl_mapped_header {
+  /** AVL_MAPPED_MAGIC terminado en cero */
+  char magic[8];
+
+  /** Versión del formato */
+  uint32_t version;
+
+  /** Tamaño en bytes de cada nodo, para detectar otra disposición */
+  uint32_t node_size;
+
+  /** Cantidad de nodos */
+  uint32_t count;
+
+  /** Índice del nodo raíz (AVL_COMPACT_NIL si el árbol está vacío) */
+  uint32_t root;
+
+  /** Reservado para versiones futuras, en cero */
+  uint32_t reserved[2];
+};
+
+/**
+ * Struct que define un árbol de solo lectura mapeado desde un archivo. Como
+ * los nodos están en orden, el índice de un nodo es también su posición:
+ * el mínimo es 0, el máximo count-1 y el siguiente de i es i+1.
+ */
+struct avl_mapped_tree {
+  /** Inicio del mapeo */
+  void *mapping;
+
+  /** Tamaño del mapeo en bytes */
+  size_t length;
+
+  /** Nodos dentro del mapeo */
+  const struct avl_compact_node *nodes;
+
+  /** Cantidad de nodos */
+  uint32_t count;
+
+  /** Índice del nodo raíz */
+  uint32_t root;
+};
+
+
+/**
+ * avl_mapped_write
+ * Escribe un árbol en un archivo con el formato mapeable.
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ * @param [in]  path     Ruta del archivo por escribir.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_mapped_write(
+  struct avl_node *in_root,
+  const char      *path);
+
+/**
+ * avl_mapped_open
+ * Mapea un archivo de árbol en memoria de solo lectura, sin copiar ni
+ * reconstruir nodos, en O(1): solo valida el encabezado y que el tamaño del
+ * archivo coincida con la cantidad de nodos, y si no retorna
+ * AVL_INVALID_PARAM. Los nodos no se leen; avl_mapped_search controla los
+ * índices que sigue, y avl_mapped_verify revisa el archivo completo.
+ *
+ * @param [in]  path  Ruta del archivo.
+ * @param [out] tree  Árbol mapeado.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_mapped_open(
+  const char             *path,
+  struct avl_mapped_tree *tree);
+
+/**
+ * avl_mapped_verify
+ * Revisa todos los nodos de un árbol mapeado en O(n), leyendo el archivo
+ * completo: que cada hijo apunte dentro del archivo, que no haya ciclos y que
+ * los valores crezcan a lo largo del arreglo. Es opcional, para archivos de
+ * origen no confiable antes de recorrerlos con índices.
+ *
+ * @param [in]  tree  Árbol mapeado.
+ *
+ * @returns error_code AVL_INVALID_PARAM si el archivo está dañado.
+ */
+int avl_mapped_verify(
+  const struct avl_mapped_tree *tree);
+
+/**
+ * avl_mapped_close
+ * Deshace el mapeo de un árbol.
+ *
+ * @param [in/out] tree  Árbol mapeado.
+ */
+void avl_mapped_close(
+  struct avl_mapped_tree *tree);
+
+/**
+ * avl_mapped_search
+ * Busca un número y devuelve el índice del nodo que lo contiene. Si el
+ * recorrido encuentra un índice fuera del arreglo o baja más de
+ * AVL_MAX_HEIGHT niveles, el archivo está dañado y retorna AVL_INVALID_PARAM.
+ *
+ * @param [in]  num          Número por buscar.
+ * @param [in]  tree         Árbol mapeado.
+ * @param [out] found_index  Índice del nodo encontrado.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_mapped_search(
+  float                         num,
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *found_index);
+
+/**
+ * avl_mapped_min_get
+ * Obtiene el índice del nodo con el valor mínimo.
+ *
+ * @param [in]  tree       Árbol mapeado.
+ * @param [out] min_index  Índice del nodo con el valor mínimo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_mapped_min_get(
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *min_index);
+
+/**
+ * avl_mapped_max_get
+ * Obtiene el índice del nodo con el valor máximo.
+ *
+ * @param [in]  tree       Árbol mapeado.
+ * @param [out] max_index  Índice del nodo con el valor máximo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_mapped_max_get(
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *max_index);
+
+/**
+ * avl_mapped_next
+ * Obtiene el índice del nodo siguiente en orden creciente.
+ *
+ * @param [in]  tree        Árbol mapeado.
+ * @param [in]  index       Índice del nodo actual.
+ * @param [out] next_index  Índice del nodo siguiente.
+ *
+ * @returns error_code    AVL_OUT_OF_RANGE si index es el último nodo
+ */
+int avl_mapped_next(
+  const struct avl_mapped_tree *tree,
+  uint32_t                      index,
+  uint32_t                     *next_index);
+
+/**
+ * avl_mapped_prev
+ * Obtiene el índice del nodo anterior en orden creciente.
+ *
+ * @param [in]  tree        Árbol mapeado.
+ * @param [in]  index       Índice del nodo actual.
+ * @param [out] prev_index  Índice del nodo anterior.
+ *
+ * @returns error_code    AVL_OUT_OF_RANGE si index es el primer nodo
+ */
+int avl_mapped_prev(
+  const struct avl_mapped_tree *tree,
+  uint32_t                      index,
+  uint32_t                     *prev_index);
+
+
+#endif /* AVL_MAPPED_H */
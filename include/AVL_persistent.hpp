@@ -0,0 +1,182 @@
+#ifndef AVL_PERSISTENT_H
+#define AVL_PERSISTENT_H
+
+#include <atomic>
+#include <mutex>
+#include "AVL_tree.hpp"
+
+/**
+ * Struct que define un nodo persistente. Una vez publicado el nodo no se
+ * modifica: las actualizaciones copian el camino desde la raíz y comparten
+ * el resto de los nodos entre versiones. Cada puntero hacia el nodo (desde
+ * un padre, un árbol o una instantánea) cuenta como una referencia.
+ */
+struct avl_pnode {
+  /** Puntero al nodo hijo izquierdo */
+  struct avl_pnode *lc_node;
+
+  /** Puntero al nodo hijo derecho */
+  struct avl_pnode *rc_node;
+
+  /** Número flotante asociado al nodo */
+  float value;
+
+  /** Altura del subárbol con raíz en el nodo */
+  int height;
+
+  /** Cantidad de nodos del subárbol con raíz en el nodo */
+  int size;
+
+  /** Cantidad de referencias al nodo */
+  std::atomic<int> refs;
+};
+
+/**
+ * Struct que define un árbol persistente. Un único escritor lo modifica
+ * mientras cualquier cantidad de lectores consulta instantáneas.
+ */
+struct avl_persistent_tree {
+  /** Raíz de la versión actual (nullptr si el árbol está vacío) */
+  struct avl_pnode *root;
+
+  /** Protege la publicación de la raíz frente a nuevas instantáneas */
+  std::mutex root_lock;
+};
+
+/**
+ * Struct que define una instantánea: una versión inmutable del árbol que
+ * sigue siendo legible aunque el escritor continúe modificándolo.
+ */
+struct avl_snapshot {
+  /** Raíz de la versión capturada */
+  struct avl_pnode *root;
+};
+
+
+/**
+ * avl_persistent_init
+ * Inicializa un árbol persistente vacío.
+ *
+ * @param [out] tree  Puntero al árbol.
+ */
+void avl_persistent_init(
+  struct avl_persistent_tree *tree);
+
+/**
+ * avl_persistent_free
+ * Suelta la versión actual del árbol. Los nodos compartidos con instantáneas
+ * aún abiertas se liberan cuando estas se sueltan.
+ *
+ * @param [in/out] tree  Puntero al árbol.
+ */
+void avl_persistent_free(
+  struct avl_persistent_tree *tree);
+
+/**
+ * avl_persistent_add
+ * Inserta un número copiando solo los nodos del camino modificado y publica
+ * la nueva versión. Los repetidos se ignoran.
+ *
+ * @param [in]     num   Número por insertar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_persistent_add(
+  float                       num,
+  struct avl_persistent_tree *tree);
+
+/**
+ * avl_persistent_remove
+ * Elimina un número copiando solo los nodos del camino modificado y publica
+ * la nueva versión. Da error si el número no pertenece al árbol.
+ *
+ * @param [in]     num   Número por eliminar.
+ * @param [in/out] tree  Puntero al árbol.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_persistent_remove(
+  float                       num,
+  struct avl_persistent_tree *tree);
+
+/**
+ * avl_persistent_snapshot
+ * Captura la versión actual del árbol en O(1).
+ *
+ * @param [in]  tree      Puntero al árbol.
+ * @param [out] snapshot  Instantánea creada.
+ */
+void avl_persistent_snapshot(
+  struct avl_persistent_tree *tree,
+  struct avl_snapshot        *snapshot);
+
+/**
+ * avl_snapshot_release
+ * Suelta una instantánea. Los nodos que ninguna otra versión comparte se
+ * liberan.
+ *
+ * @param [in/out] snapshot  Instantánea por soltar.
+ */
+void avl_snapshot_release(
+  struct avl_snapshot *snapshot);
+
+/**
+ * avl_snapshot_search
+ * Busca un número en una instantánea.
+ *
+ * @param [in]  num         Número por buscar.
+ * @param [in]  snapshot    Instantánea.
+ * @param [out] found_node  Nodo encontrado.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_snapshot_search(
+  float                       num,
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **found_node);
+
+/**
+ * avl_snapshot_min_get
+ * Obtiene el nodo con el valor mínimo de una instantánea.
+ *
+ * @param [in]  snapshot  Instantánea.
+ * @param [out] min_node  Nodo con el valor mínimo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_snapshot_min_get(
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **min_node);
+
+/**
+ * avl_snapshot_max_get
+ * Obtiene el nodo con el valor máximo de una instantánea.
+ *
+ * @param [in]  snapshot  Instantánea.
+ * @param [out] max_node  Nodo con el valor máximo.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_snapshot_max_get(
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **max_node);
+
+/**
+ * avl_snapshot_size
+ * Obtiene la cantidad de números de una instantánea.
+ *
+ * @param [in]  snapshot  Instantánea.
+ *
+ * @returns size Cantidad de nodos de la versión capturada.
+ */
+int avl_snapshot_size(
+  const struct avl_snapshot *snapshot);
+
+
+#endif /* AVL_PERSISTENT_H */
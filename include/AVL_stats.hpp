@@ -0,0 +1,214 @@
+#ifndef AVL_STATS_H
+#define AVL_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include "AVL_tree.hpp"
+
+/**
+ * Contadores de operaciones. Solo se compilan si se define AVL_STATS (opción
+ * AVL_STATS de CMake); sin ella los puntos de medición no generan código y
+ * avl_stats_snapshot retorna AVL_NOT_FOUND.
+ *
+ * Los contadores se registran en el avl_stats asociado al hilo con
+ * avl_stats_bind: para medir un árbol, el hilo que lo modifica asocia las
+ * estadísticas de ese árbol antes de operar sobre él. Los nodos que crean o
+ * liberan hilos auxiliares (construcción paralela, operaciones de
+ * conjuntos y avl_background_free) no se registran.
+ */
+
+/** Cantidad de entradas del histograma de profundidad (0 a AVL_MAX_HEIGHT) */
+#define AVL_STATS_DEPTHS (AVL_MAX_HEIGHT+1)
+
+/**
+ * Tipos de operación con contadores propios
+ */
+enum avl_stats_operation {
+  AVL_STATS_INSERT = 0,
+  AVL_STATS_REMOVE,
+  AVL_STATS_SEARCH,
+  AVL_STATS_OPERATIONS
+};
+
+/**
+ * Struct con los contadores de un árbol. Lo escribe un solo hilo a la vez
+ * (el que modifica el árbol) sin instrucciones atómicas de
+ * lectura-modificación-escritura, y puede leerse desde otro hilo con
+ * avl_stats_snapshot.
+ */
+struct avl_stats {
+  /** Llamadas por tipo de operación */
+  std::atomic<uint64_t> operations[AVL_STATS_OPERATIONS];
+
+  /** Comparaciones de llaves por tipo de operación */
+  std::atomic<uint64_t> comparisons[AVL_STATS_OPERATIONS];
+
+  /** Rotaciones simples por tipo de operación */
+  std::atomic<uint64_t> single_rotations[AVL_STATS_OPERATIONS];
+
+  /** Rotaciones dobles por tipo de operación */
+  std::atomic<uint64_t> double_rotations[AVL_STATS_OPERATIONS];
+
+  /** Descensos por profundidad alcanzada (la raíz tiene profundidad 0) */
+  std::atomic<uint64_t> depths[AVL_STATS_OPERATIONS][AVL_STATS_DEPTHS];
+
+  /** Nodos reservados */
+  std::atomic<uint64_t> allocations;
+
+  /** Nodos liberados */
+  std::atomic<uint64_t> frees;
+
+  /** Bytes de nodos en uso */
+  std::atomic<int64_t> live_bytes;
+};
+
+/**
+ * Copia de los contadores de un avl_stats, lista para exportar.
+ */
+struct avl_stats_counters {
+  uint64_t operations[AVL_STATS_OPERATIONS];
+  uint64_t comparisons[AVL_STATS_OPERATIONS];
+  uint64_t single_rotations[AVL_STATS_OPERATIONS];
+  uint64_t double_rotations[AVL_STATS_OPERATIONS];
+  uint64_t depths[AVL_STATS_OPERATIONS][AVL_STATS_DEPTHS];
+  uint64_t allocations;
+  uint64_t frees;
+  int64_t  live_bytes;
+};
+
+
+/**
+ * avl_stats_reset
+ * Pone en cero todos los contadores.
+ *
+ * @param [out] stats  Contadores.
+ */
+void avl_stats_reset(
+  struct avl_stats *stats);
+
+/**
+ * avl_stats_bind
+ * Asocia los contadores al hilo que llama; las operaciones siguientes de
+ * ese hilo se registran en ellos. nullptr deja de registrar.
+ *
+ * @param [in]  stats  Contadores por asociar, o nullptr.
+ *
+ * @returns previous   los contadores asociados antes de la llamada
+ */
+struct avl_stats *avl_stats_bind(
+  struct avl_stats *stats);
+
+/**
+ * avl_stats_snapshot
+ * Copia los contadores, aunque otro hilo los esté actualizando.
+ *
+ * @param [in]  stats     Contadores.
+ * @param [out] snapshot  Copia de los contadores.
+ *
+ * @returns error_code    AVL_NOT_FOUND si se compiló sin AVL_STATS
+ */
+int avl_stats_snapshot(
+  const struct avl_stats    *stats,
+  struct avl_stats_counters *snapshot);
+
+
+#ifdef AVL_STATS
+
+namespace avl_detail {
+
+/** Contadores asociados al hilo, o nullptr */
+extern thread_local struct avl_stats *stats_target;
+
+/** Operación en curso del hilo, o -1 fuera de una operación medida */
+extern thread_local int stats_operation;
+
+// Single writer per counter: a relaxed load and store, no locked add.
+template<class Counter, class Amount>
+inline void stats_add(
+  Counter &counter,
+  Amount   amount){
+    counter.store(counter.load(std::memory_order_relaxed)+amount,
+                  std::memory_order_relaxed);
+}
+
+// Marks the operation in course for the hooks below and counts the call.
+class stats_scope {
+  int previous;
+public:
+  explicit stats_scope(
+    int operation) : previous(stats_operation){
+      stats_operation=operation;
+      if (stats_target != nullptr){
+          stats_add(stats_target->operations[operation],1);
+      }
+  }
+  ~stats_scope(){
+      stats_operation=previous;
+  }
+};
+
+inline bool stats_active(){
+    return stats_target != nullptr && stats_operation >= 0;
+}
+
+inline void stats_compare(){
+    if (stats_active()){
+        stats_add(stats_target->comparisons[stats_operation],1);
+    }
+}
+
+inline void stats_depth(
+  int depth){
+    if (stats_active()){
+        int bucket=(depth < AVL_STATS_DEPTHS) ? depth : AVL_STATS_DEPTHS-1;
+        stats_add(stats_target->depths[stats_operation][bucket],1);
+    }
+}
+
+inline void stats_rotation(
+  bool is_double){
+    if (stats_active()){
+        stats_add(is_double ? stats_target->double_rotations[stats_operation] :
+                              stats_target->single_rotations[stats_operation],1);
+    }
+}
+
+inline void stats_memory(
+  int64_t nodes,
+  int64_t bytes){
+    if (stats_target != nullptr){
+        if (nodes > 0){
+            stats_add(stats_target->allocations,static_cast<uint64_t>(nodes));
+        }
+        else {
+            stats_add(stats_target->frees,static_cast<uint64_t>(-nodes));
+        }
+        stats_add(stats_target->live_bytes,bytes);
+    }
+}
+
+} /* namespace avl_detail */
+
+#define AVL_STATS_SCOPE(operation) avl_detail::stats_scope avl_stats_scope(operation)
+#define AVL_STATS_COMPARE() avl_detail::stats_compare()
+#define AVL_STATS_DEPTH(depth) avl_detail::stats_depth(depth)
+#define AVL_STATS_ROTATION(is_double) avl_detail::stats_rotation(is_double)
+#define AVL_STATS_ALLOC(nodes, bytes) \
+  avl_detail::stats_memory(nodes,static_cast<int64_t>(bytes))
+#define AVL_STATS_FREE(nodes, bytes) \
+  avl_detail::stats_memory(-(nodes),-static_cast<int64_t>(bytes))
+
+#else
+
+// Compiled out: arguments are still named so that no variable looks unused.
+#define AVL_STATS_SCOPE(operation) ((void)0)
+#define AVL_STATS_COMPARE() ((void)0)
+#define AVL_STATS_DEPTH(depth) ((void)(depth))
+#define AVL_STATS_ROTATION(is_double) ((void)(is_double))
+#define AVL_STATS_ALLOC(nodes, bytes) ((void)0)
+#define AVL_STATS_FREE(nodes, bytes) ((void)0)
+
+#endif /* AVL_STATS */
+
+
+#endif /* AVL_STATS_H */
@@ -0,0 +1,153 @@
+#ifndef AVL_TRACE_H
+#define AVL_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "AVL_tree.hpp"
+
+/**
+ * Trazas de operaciones en formato Chrome/Perfetto. Solo se compilan si se
+ * define AVL_TRACE (opción AVL_TRACE de CMake); sin ella los intervalos no
+ * generan código y avl_trace_start retorna AVL_NOT_FOUND.
+ *
+ * Cada hilo registra sus intervalos en su propio buffer circular, sin
+ * locks. Con la traza compilada pero detenida, cada intervalo cuesta una
+ * lectura y un salto predecible. El buffer de un hilo terminado se
+ * reutiliza para otro hilo cuando sus intervalos ya se escribieron con
+ * avl_trace_dump o son anteriores al último avl_trace_start, así que los
+ * hilos de corta vida no acumulan memoria.
+ */
+
+/** Intervalos por hilo antes de sobrescribir los más antiguos (potencia de 2) */
+#ifndef AVL_TRACE_CAPACITY
+#define AVL_TRACE_CAPACITY 16384
+#endif
+
+
+/**
+ * avl_trace_start
+ * Empieza a registrar intervalos. Un archivo escrito después solo incluye
+ * los intervalos iniciados desde esta llamada.
+ *
+ * @returns error_code    AVL_NOT_FOUND si se compiló sin AVL_TRACE
+ */
+int avl_trace_start();
+
+/**
+ * avl_trace_stop
+ * Deja de registrar intervalos; los registrados se conservan.
+ */
+void avl_trace_stop();
+
+/**
+ * avl_trace_dump
+ * Escribe los intervalos de todos los hilos como JSON de Chrome/Perfetto
+ * (chrome://tracing o ui.perfetto.dev). De un buffer lleno se escriben los
+ * AVL_TRACE_CAPACITY-1 intervalos más recientes, porque el más antiguo
+ * puede estar sobrescribiéndose; si otros hilos siguen registrando, los
+ * intervalos que sobrescriben durante la escritura también se descartan.
+ *
+ * @param [in]  path  Ruta del archivo por escribir.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_trace_dump(
+  const char *path);
+
+
+#ifdef AVL_TRACE
+
+static_assert((AVL_TRACE_CAPACITY & (AVL_TRACE_CAPACITY-1)) == 0,
+              "AVL_TRACE_CAPACITY must be a power of two");
+
+namespace avl_detail {
+
+// One complete span. Fields are atomics so that a dump may read a buffer
+// while its thread writes it.
+struct trace_event {
+  std::atomic<const char *> name;
+  std::atomic<uint64_t>     start;
+  std::atomic<uint64_t>     duration;
+};
+
+// Ring of spans owned by one thread. head counts every span ever written.
+// Once its thread exits the buffer is retired, and it is handed to a new
+// thread after a dump wrote its spans (dumped is the head written last).
+// tid and dumped change only with the registry lock held.
+struct trace_buffer {
+  std::atomic<uint64_t> head;
+  std::atomic<bool>     retired;
+  uint64_t              dumped;
+  int                   tid;
+  struct trace_event    events[AVL_TRACE_CAPACITY];
+};
+
+/** Indica si se están registrando intervalos */
+extern std::atomic<bool> trace_enabled;
+
+/** Buffer del hilo, o nullptr antes de su primer intervalo */
+extern thread_local struct trace_buffer *trace_local;
+
+/**
+ * trace_register
+ * Asigna al hilo que llama un buffer retirado o uno nuevo. Se llama una vez
+ * por hilo.
+ */
+struct trace_buffer *trace_register();
+
+inline uint64_t trace_now(){
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void trace_record(
+  const char *name,
+  uint64_t    start,
+  uint64_t    stop){
+    struct trace_buffer *buffer=trace_local;
+    if (buffer == nullptr){
+        buffer=trace_register();
+    }
+
+    // Only this thread writes head. The fence keeps the previous head
+    // visible before the slot is overwritten, the release publishes it.
+    uint64_t head=buffer->head.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    struct trace_event &event=buffer->events[head & (AVL_TRACE_CAPACITY-1)];
+    event.name.store(name,std::memory_order_relaxed);
+    event.start.store(start,std::memory_order_relaxed);
+    event.duration.store(stop-start,std::memory_order_relaxed);
+    buffer->head.store(head+1,std::memory_order_release);
+}
+
+// Records the lifetime of the scope as one span.
+class trace_span {
+  const char *name;
+  uint64_t    start;
+public:
+  explicit trace_span(
+    const char *span_name) : name(span_name), start(0){
+      if (trace_enabled.load(std::memory_order_relaxed)){
+          start=trace_now();
+      }
+  }
+  ~trace_span(){
+      if (start != 0){
+          trace_record(name,start,trace_now());
+      }
+  }
+};
+
+} /* namespace avl_detail */
+
+#define AVL_TRACE_SPAN(name) avl_detail::trace_span avl_trace_span(name)
+
+#else
+
+#define AVL_TRACE_SPAN(name) ((void)0)
+
+#endif /* AVL_TRACE */
+
+
+#endif /* AVL_TRACE_H */
@@ -3,6 +3,15 @@
 
 #define MAX_RAND_VALUE 100
 
+/**
+ * Altura máxima de un árbol AVL con menos de 2^32 nodos (1.44*log2(n+2)),
+ * usada para dimensionar las pilas de recorrido.
+ */
+#define AVL_MAX_HEIGHT 64
+
+/** Cantidad de nodos por bloque por defecto para avl_pool */
+#define AVL_POOL_SLAB_SIZE 4096
+
 /**
  * Códigos de error
  */
@@ -15,6 +24,26 @@ enum avl_error_codes {
   AVL_INVALID_ROT   = -5
 };
 
+/**
+ * Órdenes de recorrido de avl_traverse. Las variantes de Morris usan O(1)
+ * memoria extra enlazando temporalmente el árbol.
+ */
+enum avl_traversal_order {
+  AVL_PRE_ORDER        = 0,
+  AVL_IN_ORDER         = 1,
+  AVL_LEVEL_ORDER      = 2,
+  AVL_MORRIS_PRE_ORDER = 3,
+  AVL_MORRIS_IN_ORDER  = 4
+};
+
+/**
+ * Momento en que avl_erase_range libera los nodos quitados
+ */
+enum avl_free_mode {
+  AVL_FREE_NOW        = 0,
+  AVL_FREE_BACKGROUND = 1
+};
+
 /**
  * Struct que define un nodo de la estructura de datos
  */
@@ -25,11 +54,76 @@ struct avl_node {
   /** Puntero al nodo hijo derecho */
   struct avl_node *rc_node;
 
+  /** Puntero al nodo padre (nullptr en la raíz) */
+  struct avl_node *parent;
+
   /** Número flotante asociado al nodo */
   float value;
+
+  /** Altura del subárbol cuya raíz es este nodo (una hoja tiene altura 1) */
+  int height;
+
+  /** Cantidad de nodos del subárbol cuya raíz es este nodo */
+  int size;
+
+  /**
+   * Repeticiones del valor (siempre 1 fuera del modo multiconjunto). Con
+   * total, agrega 8 bytes a cada nodo (de 40 a 48 en x86-64) y una suma a
+   * cada actualización, aunque el árbol no use el modo multiconjunto
+   */
+  int count;
+
+  /** Suma de las repeticiones del subárbol cuya raíz es este nodo */
+  int total;
+};
+
+
+/**
+ * Struct que define un bloque contiguo de nodos reservado por un avl_pool
+ */
+struct avl_slab {
+  /** Puntero al siguiente bloque del pool */
+  struct avl_slab *next;
+
+  /** Arreglo de nodos del bloque */
+  struct avl_node *nodes;
+};
+
+/**
+ * Struct que define un pool de nodos por árbol. Los nodos se toman de bloques
+ * contiguos y los nodos eliminados se reutilizan mediante una lista libre.
+ */
+struct avl_pool {
+  /** Lista de bloques reservados */
+  struct avl_slab *slabs;
+
+  /** Lista libre de nodos eliminados, enlazada por lc_node */
+  struct avl_node *free_list;
+
+  /** Siguiente nodo sin usar del bloque actual */
+  struct avl_node *next_free;
+
+  /** Nodos sin usar restantes en el bloque actual */
+  int remaining;
+
+  /** Cantidad de nodos por bloque */
+  int slab_size;
+
+  /** Cantidad de nodos actualmente en uso */
+  int live_nodes;
 };
 
 
+/**
+ * Función de visita para recorridos: recibe cada nodo visitado y el contexto
+ * del usuario. Si retorna un código distinto de AVL_SUCCESS, el recorrido se
+ * detiene y se retorna ese código.
+ */
+typedef int (*avl_visitor)(
+  struct avl_node *node,
+  void            *context);
+
+
 /**
  * max
  * Toma un par de códigos de error y devuelve el menor entre ellos.
@@ -78,7 +172,8 @@ int min3(
 
 /**
  * median
- * Toma una lista de números y encuentra su mediana.
+ * Toma una lista de números y encuentra su mediana en O(n) con selección
+ * parcial. La lista queda reordenada.
  * Retorna el valor de la mediana.
  *
  * @param [in]  in_list   Input list.
@@ -92,7 +187,8 @@ float median(
 
 /**
  * get_height
- * Calcula la altura de un nodo.
+ * Obtiene la altura de un nodo a partir del valor almacenado en él, sin
+ * recorrer el subárbol. Un nodo nulo tiene altura 0.
  * Retorna la altura del nodo.
  *
  * @param [in]  current_node  Puntero al nodo.
@@ -102,6 +198,28 @@ float median(
 int get_height(
   struct avl_node *current_node);
 
+/**
+ * get_size
+ * Obtiene la cantidad de nodos del subárbol de un nodo a partir del valor
+ * almacenado en él. Un nodo nulo tiene tamaño 0.
+ *
+ * @param [in]  current_node  Puntero al nodo.
+ *
+ * @returns size Cantidad de nodos del subárbol.
+ */
+int get_size(
+  struct avl_node *current_node);
+
+/**
+ * update_height
+ * Recalcula la altura y el tamaño almacenados en un nodo a partir de los de
+ * sus hijos. Debe llamarse cada vez que cambian los hijos del nodo.
+ *
+ * @param [in/out]  current_node  Puntero al nodo.
+ */
+void update_height(
+  struct avl_node *current_node);
+
 /**
  * get_balance
  * Calcula el factor de balance de un nodo h(LeftChild)-h(RightChild).
@@ -128,6 +246,58 @@ int new_node(
   float value);
 
 
+/**
+ * avl_pool_init
+ * Inicializa un pool de nodos vacío.
+ *
+ * @param [out] pool       Puntero al pool.
+ * @param [in]  slab_size  Cantidad de nodos por bloque (ej. AVL_POOL_SLAB_SIZE).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_pool_init(
+  struct avl_pool *pool,
+  int              slab_size);
+
+/**
+ * avl_pool_new_node
+ * Crea un nuevo nodo con el valor indicado tomándolo del pool. Reutiliza
+ * primero los nodos liberados.
+ *
+ * @param [in/out] pool      Puntero al pool.
+ * @param [out]    node_ptr  Puntero al nodo creado.
+ * @param [in]     value     Valor para el nodo.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_pool_new_node(
+  struct avl_pool  *pool,
+  struct avl_node **node_ptr,
+  float             value);
+
+/**
+ * avl_pool_free_node
+ * Devuelve un nodo al pool para que sea reutilizado.
+ *
+ * @param [in/out] pool  Puntero al pool.
+ * @param [in]     node  Nodo por liberar.
+ */
+void avl_pool_free_node(
+  struct avl_pool *pool,
+  struct avl_node *node);
+
+/**
+ * avl_pool_release
+ * Libera de una vez todos los bloques del pool, junto con todos los árboles
+ * construidos sobre él, sin recorrer los nodos. El pool queda vacío y listo
+ * para reutilizarse.
+ *
+ * @param [in/out] pool  Puntero al pool.
+ */
+void avl_pool_release(
+  struct avl_pool *pool);
+
+
 /**
  * left_rotation
  * Realiza una rotación a la izquierda sobre el nodo dado.
@@ -168,6 +338,7 @@ float *random_list(
 /**
  * free_tree_mem
  * Libera la memoria asignada a cada nodo del arbol.
+ * Los árboles construidos sobre un avl_pool se liberan con avl_pool_release.
  *
  * @param [in] root_node  Puntero a la raíz del árbol.
  *
@@ -175,6 +346,23 @@ float *random_list(
 void free_tree_mem(
   struct avl_node *root_node);
 
+/**
+ * avl_background_free
+ * Entrega un árbol a un hilo de fondo que lo libera con free_tree_mem, y
+ * retorna sin esperar. El árbol ya no debe usarse.
+ *
+ * @param [in] root_node  Puntero a la raíz del árbol.
+ */
+void avl_background_free(
+  struct avl_node *root_node);
+
+/**
+ * avl_background_wait
+ * Espera a que el hilo de fondo termine de liberar todos los árboles que
+ * recibió hasta el momento.
+ */
+void avl_background_wait();
+
 /**
  * avl_create
  * Toma una lista de números flotantes, y crea la estructura de datos deseada.
@@ -192,6 +380,99 @@ int avl_create(
   struct avl_node **new_root_node);
 
 
+/**
+ * avl_build_sorted
+ * Construye un árbol perfectamente balanceado a partir de una lista ordenada
+ * de forma estrictamente creciente (sin repetidos), de abajo hacia arriba en
+ * O(n) y sin rotaciones.
+ *
+ * @param [in]  sorted_list    Lista ordenada de números flotantes.
+ * @param [in]  list_size      Tamaño de la lista.
+ * @param [out] new_root_node  Puntero al nodo raíz del árbol creado.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_build_sorted(
+  const float      *sorted_list,
+  int               list_size,
+  struct avl_node **new_root_node);
+
+/**
+ * avl_bulk_create
+ * Variante de avl_create para cargas masivas: ordena y elimina repetidos de
+ * una copia de la lista una sola vez y construye el árbol con
+ * avl_build_sorted. Si el árbol ya tiene nodos, agrega los elementos uno a
+ * uno como avl_create.
+ *
+ * @param [in]  in_number_list Lista de números flotantes de entrada.
+ * @param [in]  list_size      Tamaño de la lista.
+ * @param [out] new_root_node  Puntero al nodo raíz del árbol creado.
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_bulk_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node);
+
+
+/**
+ * avl_pool_build_sorted
+ * Igual que avl_build_sorted, pero los nodos se toman del pool dado.
+ *
+ * @param [in]     sorted_list    Lista ordenada de números flotantes.
+ * @param [in]     list_size      Tamaño de la lista.
+ * @param [out]    new_root_node  Puntero al nodo raíz del árbol creado.
+ * @param [in/out] pool           Pool de nodos (nullptr usa el heap).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_pool_build_sorted(
+  const float      *sorted_list,
+  int               list_size,
+  struct avl_node **new_root_node,
+  struct avl_pool  *pool);
+
+/**
+ * avl_pool_bulk_create
+ * Igual que avl_bulk_create, pero los nodos se toman del pool dado.
+ *
+ * @param [in]     in_number_list Lista de números flotantes de entrada.
+ * @param [in]     list_size      Tamaño de la lista.
+ * @param [out]    new_root_node  Puntero al nodo raíz del árbol creado.
+ * @param [in/out] pool           Pool de nodos (nullptr usa el heap).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_pool_bulk_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_parallel_create
+ * Variante de avl_bulk_create para listas muy grandes y desordenadas: ordena
+ * la copia de la lista por bloques en paralelo y los mezcla en paralelo,
+ * elimina repetidos y construye subárboles disjuntos en hilos distintos, que
+ * luego se unen bajo sus elementos centrales. El árbol debe estar vacío y
+ * los nodos se reservan en el heap.
+ *
+ * @param [in]  in_number_list Lista de números flotantes de entrada.
+ * @param [in]  list_size      Tamaño de la lista.
+ * @param [out] new_root_node  Puntero al nodo raíz del árbol creado.
+ * @param [in]  thread_count   Cantidad máxima de hilos (1 es secuencial).
+ *
+ * @returns error_code Código de error indicando el éxito o error de la función.
+ */
+int avl_parallel_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node,
+  int              thread_count);
+
+
 /**
  * avl_node_add
  * Toma un nodo y lo inserta en la estructura de datos.
@@ -211,7 +492,8 @@ int avl_node_add(
 /**
  * avl_node_remove
  * Toma un nodo arbitrario, lo busca y lo elimina de la estructura de datos.
- * Da error si el nodo no pertenece al árbol.
+ * Da error si el nodo no pertenece al árbol. Un valor con repeticiones se
+ * elimina con todas ellas.
  *
  * @param [in]  num            Número por eleminar
  * @param [out] new_root       es el puntero al nuevo nodo raíz del árbol
@@ -224,6 +506,497 @@ int avl_node_remove(
   struct avl_node **new_root);
 
 
+/**
+ * avl_pool_node_add
+ * Igual que avl_node_add, pero el nuevo nodo se toma del pool dado.
+ *
+ * @param [in]     num       Número por insertar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_node_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_pool_node_remove
+ * Igual que avl_node_remove, pero el nodo eliminado vuelve al pool dado.
+ *
+ * @param [in]     num       Número por eliminar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_node_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_hint_add
+ * Igual que avl_node_add, pero la búsqueda empieza en hint, un nodo del
+ * árbol cercano a num, en vez de en la raíz: cuesta O(log d) comparaciones
+ * para un valor a distancia d del dedo. Al volver, hint apunta al nodo con
+ * num, así que una secuencia casi ordenada puede pasar siempre el mismo
+ * hint; con hint en el máximo, un valor mayor se agrega sin comparar llaves
+ * fuera de hint.
+ *
+ * @param [in]     num       Número por insertar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] hint      Nodo cercano a num (nullptr empieza en la raíz)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_hint_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint);
+
+
+/**
+ * avl_pool_hint_add
+ * Igual que avl_hint_add, pero el nuevo nodo se toma del pool dado.
+ *
+ * @param [in]     num       Número por insertar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] hint      Nodo cercano a num (nullptr empieza en la raíz)
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_hint_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_hint_remove
+ * Igual que avl_node_remove, pero la búsqueda empieza en hint. Al volver,
+ * hint apunta al sucesor del valor eliminado (o a su predecesor si era el
+ * máximo, o nullptr si el árbol quedó vacío).
+ *
+ * @param [in]     num       Número por eliminar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] hint      Nodo cercano a num (nullptr empieza en la raíz)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_hint_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint);
+
+
+/**
+ * avl_pool_hint_remove
+ * Igual que avl_hint_remove, pero el nodo eliminado vuelve al pool dado.
+ *
+ * @param [in]     num       Número por eliminar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] hint      Nodo cercano a num (nullptr empieza en la raíz)
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_hint_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_multi_add
+ * Modo multiconjunto: inserta una repetición de num. Si el valor ya existe
+ * solo aumenta su cantidad de repeticiones, sin reservar ni rotar nodos.
+ *
+ * @param [in]  num       Número por insertar
+ * @param [out] new_root  es el puntero al nuevo nodo raíz del árbol
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_multi_add(
+  float num,
+  struct avl_node **new_root);
+
+
+/**
+ * avl_pool_multi_add
+ * Igual que avl_multi_add, pero un nuevo nodo se toma del pool dado.
+ *
+ * @param [in]     num       Número por insertar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_multi_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_multi_remove
+ * Modo multiconjunto: elimina una repetición de num. El nodo solo se quita
+ * del árbol con su última repetición. Da error si el número no pertenece al
+ * árbol.
+ *
+ * @param [in]  num       Número por eliminar
+ * @param [out] new_root  es el puntero al nuevo nodo raíz del árbol
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_multi_remove(
+  float num,
+  struct avl_node **new_root);
+
+
+/**
+ * avl_pool_multi_remove
+ * Igual que avl_multi_remove, pero un nodo eliminado vuelve al pool dado.
+ *
+ * @param [in]     num       Número por eliminar
+ * @param [out]    new_root  es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool      Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_multi_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_multi_count
+ * Obtiene la cantidad de repeticiones de num (0 si no pertenece al árbol).
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ * @param [in]  num      es el número flotante buscado
+ * @param [out] count    cantidad de repeticiones
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_multi_count(
+  struct avl_node  *in_root,
+  float             num,
+  int              *count);
+
+
+/**
+ * avl_multi_size
+ * Cantidad de valores del árbol contando sus repeticiones.
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ *
+ * @returns total        suma de las repeticiones de todos los nodos
+ */
+int avl_multi_size(
+  struct avl_node *in_root);
+
+
+/**
+ * avl_multi_rank
+ * Igual que avl_rank, pero cada valor cuenta tantas veces como se repite.
+ *
+ * @param [in]  in_root  es el nodo raíz original del árbol
+ * @param [in]  num      es el número flotante de referencia
+ * @param [out] rank     cantidad de repeticiones de valores menores que num
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_multi_rank(
+  struct avl_node  *in_root,
+  float             num,
+  int              *rank);
+
+
+/**
+ * avl_multi_select
+ * Igual que avl_select, pero k recorre todas las repeticiones: devuelve el
+ * nodo que contiene la k-ésima repetición en orden creciente (k desde 0).
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  k           posición buscada en orden creciente
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_multi_select(
+  struct avl_node  *in_root,
+  int               k,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_insert_batch
+ * Inserta un lote de números en una sola pasada: ordena el lote, lo divide
+ * en cada nodo entre sus dos subárboles y rebalancea una vez cada subárbol
+ * afectado. Los repetidos se ignoran.
+ *
+ * @param [in]  batch       Lote de números por insertar.
+ * @param [in]  batch_size  Tamaño del lote.
+ * @param [out] new_root    es el puntero al nuevo nodo raíz del árbol
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_insert_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root);
+
+
+/**
+ * avl_pool_insert_batch
+ * Igual que avl_insert_batch, pero los nodos se toman del pool dado.
+ *
+ * @param [in]     batch       Lote de números por insertar.
+ * @param [in]     batch_size  Tamaño del lote.
+ * @param [out]    new_root    es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool        Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_insert_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_remove_batch
+ * Elimina un lote de números en una sola pasada, dividiendo el lote ordenado
+ * en cada nodo. Se eliminan todos los valores presentes; si alguno no
+ * pertenece al árbol se retorna AVL_OUT_OF_RANGE.
+ *
+ * @param [in]  batch       Lote de números por eliminar.
+ * @param [in]  batch_size  Tamaño del lote.
+ * @param [out] new_root    es el puntero al nuevo nodo raíz del árbol
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_remove_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root);
+
+
+/**
+ * avl_pool_remove_batch
+ * Igual que avl_remove_batch, pero los nodos eliminados vuelven al pool.
+ *
+ * @param [in]     batch       Lote de números por eliminar.
+ * @param [in]     batch_size  Tamaño del lote.
+ * @param [out]    new_root    es el puntero al nuevo nodo raíz del árbol
+ * @param [in/out] pool        Pool de nodos del árbol (nullptr usa el heap)
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_remove_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+
+/**
+ * avl_union
+ * Une dos árboles en uno con los valores de ambos, dividiendo un árbol con
+ * la raíz del otro y uniendo subárboles completos con join. Cuesta
+ * O(m log(n/m + 1)) para árboles de tamaños m <= n. Ambos árboles de entrada
+ * se consumen y sus nodos pasan al resultado o se liberan. Solo para árboles
+ * creados sobre el heap (sin avl_pool).
+ *
+ * @param [in]  first_root    Raíz del primer árbol.
+ * @param [in]  second_root   Raíz del segundo árbol.
+ * @param [out] new_root      Raíz del árbol resultante.
+ * @param [in]  thread_count  Cantidad máxima de hilos (1 es secuencial).
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_union(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count);
+
+
+/**
+ * avl_intersection
+ * Deja en un árbol solo los valores presentes en ambos árboles, con el mismo
+ * esquema basado en join que avl_union. Ambos árboles se consumen.
+ *
+ * @param [in]  first_root    Raíz del primer árbol.
+ * @param [in]  second_root   Raíz del segundo árbol.
+ * @param [out] new_root      Raíz del árbol resultante.
+ * @param [in]  thread_count  Cantidad máxima de hilos (1 es secuencial).
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_intersection(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count);
+
+
+/**
+ * avl_difference
+ * Deja en un árbol los valores del primer árbol que no están en el segundo,
+ * con el mismo esquema basado en join que avl_union. Ambos árboles se
+ * consumen.
+ *
+ * @param [in]  first_root    Raíz del primer árbol.
+ * @param [in]  second_root   Raíz del segundo árbol.
+ * @param [out] new_root      Raíz del árbol resultante.
+ * @param [in]  thread_count  Cantidad máxima de hilos (1 es secuencial).
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_difference(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count);
+
+
+/**
+ * avl_split
+ * Divide un árbol en los valores menores que num (left) y los mayores o
+ * iguales (right) en O(log n), sin crear ni liberar nodos. El árbol de
+ * entrada se consume y su raíz queda en nullptr.
+ *
+ * @param [in/out] in_root  Raíz del árbol por dividir.
+ * @param [in]     num      Valor de corte.
+ * @param [out]    left     Raíz del árbol con los valores menores que num.
+ * @param [out]    right    Raíz del árbol con los valores mayores o iguales.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_split(
+  struct avl_node **in_root,
+  float             num,
+  struct avl_node **left,
+  struct avl_node **right);
+
+/**
+ * avl_join
+ * Une dos árboles con un nodo nuevo de valor num en O(|h(left)-h(right)|+1).
+ * Todos los valores de left deben ser menores que num y todos los de right
+ * mayores; si no, da error y no modifica los árboles. Ambos árboles se
+ * consumen.
+ *
+ * @param [in]  left      Raíz del árbol con los valores menores.
+ * @param [in]  num       Valor del nodo intermedio.
+ * @param [in]  right     Raíz del árbol con los valores mayores.
+ * @param [out] new_root  Raíz del árbol resultante.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_join(
+  struct avl_node  *left,
+  float             num,
+  struct avl_node  *right,
+  struct avl_node **new_root);
+
+/**
+ * avl_pool_join
+ * Igual que avl_join, pero el nodo intermedio se toma del pool dado.
+ *
+ * @param [in]     left      Raíz del árbol con los valores menores.
+ * @param [in]     num       Valor del nodo intermedio.
+ * @param [in]     right     Raíz del árbol con los valores mayores.
+ * @param [out]    new_root  Raíz del árbol resultante.
+ * @param [in/out] pool      Pool de nodos.
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_join(
+  struct avl_node  *left,
+  float             num,
+  struct avl_node  *right,
+  struct avl_node **new_root,
+  struct avl_pool  *pool);
+
+/**
+ * avl_erase_range
+ * Quita los valores en [low, high) con dos divisiones y una unión, en
+ * O(log n) más el costo de liberar los nodos quitados. Con
+ * AVL_FREE_BACKGROUND los nodos se entregan a avl_background_free y el
+ * costo de liberarlos sale de la llamada. Solo para árboles creados sobre
+ * el heap (sin avl_pool).
+ *
+ * @param [in]     low        límite inferior (incluido)
+ * @param [in]     high       límite superior (excluido)
+ * @param [in/out] new_root   Raíz del árbol.
+ * @param [in]     free_mode  Momento de liberar los nodos (avl_free_mode).
+ * @param [out]    removed    Cantidad de valores quitados (puede ser nullptr).
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_erase_range(
+  float             low,
+  float             high,
+  struct avl_node **new_root,
+  int               free_mode,
+  int              *removed);
+
+/**
+ * avl_pool_erase_range
+ * Igual que avl_erase_range, pero devuelve los nodos quitados al pool dado
+ * durante la llamada.
+ *
+ * @param [in]     low       límite inferior (incluido)
+ * @param [in]     high      límite superior (excluido)
+ * @param [in/out] new_root  Raíz del árbol.
+ * @param [in/out] pool      Pool de nodos.
+ * @param [out]    removed   Cantidad de valores quitados (puede ser nullptr).
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_pool_erase_range(
+  float             low,
+  float             high,
+  struct avl_node **new_root,
+  struct avl_pool  *pool,
+  int              *removed);
+
+
 /**
  * avl_search
  * Toma un número flotante, lo busca y se devuelve el nodo al que pertenece.
@@ -273,6 +1046,230 @@ int avl_min_get(
   struct avl_node **min_node);
 
 
+/**
+ * avl_rank
+ * Cuenta los valores del árbol estrictamente menores que num, en O(log n)
+ * usando los tamaños de los subárboles. El valor no necesita estar en el
+ * árbol.
+ *
+ * @param [in]  in_root   es el nodo raíz original del árbol
+ * @param [in]  num       es el número flotante de referencia
+ * @param [out] rank      cantidad de valores menores que num
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_rank(
+  struct avl_node  *in_root,
+  float             num,
+  int              *rank);
+
+
+/**
+ * avl_select
+ * Obtiene el nodo con el k-ésimo menor valor del árbol (k desde 0), en
+ * O(log n). Da error si k no está entre 0 y el tamaño del árbol menos uno.
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  k           posición buscada en orden creciente
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_select(
+  struct avl_node  *in_root,
+  int               k,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_median
+ * Calcula la mediana de los valores del árbol en O(log n), sin copiarlos ni
+ * ordenarlos. Con una cantidad par de valores se promedian los dos centrales.
+ *
+ * @param [in]  in_root       es el nodo raíz original del árbol
+ * @param [out] median_value  es la mediana de los valores
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_median(
+  struct avl_node  *in_root,
+  float            *median_value);
+
+
+/**
+ * avl_lower_bound
+ * Obtiene el nodo con el menor valor mayor o igual que num, en O(log n).
+ * Da error si el árbol está vacío o si ningún valor cumple la condición.
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  num         es el número flotante de referencia
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_lower_bound(
+  struct avl_node  *in_root,
+  float             num,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_upper_bound
+ * Obtiene el nodo con el menor valor estrictamente mayor que num, en
+ * O(log n). Da error si el árbol está vacío o si ningún valor cumple la
+ * condición.
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  num         es el número flotante de referencia
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_upper_bound(
+  struct avl_node  *in_root,
+  float             num,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_floor
+ * Obtiene el nodo con el mayor valor menor o igual que num, en O(log n).
+ * Da error si el árbol está vacío o si ningún valor cumple la condición.
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  num         es el número flotante de referencia
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_floor(
+  struct avl_node  *in_root,
+  float             num,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_ceiling
+ * Obtiene el nodo con el menor valor mayor o igual que num (equivale a
+ * avl_lower_bound).
+ *
+ * @param [in]  in_root     es el nodo raíz original del árbol
+ * @param [in]  num         es el número flotante de referencia
+ * @param [out] found_node  es el nodo encontrado
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_ceiling(
+  struct avl_node  *in_root,
+  float             num,
+  struct avl_node **found_node);
+
+
+/**
+ * avl_range_count
+ * Cuenta los valores en el intervalo [low, high) en O(log n) usando los
+ * tamaños de los subárboles. Da error si low > high; si low == high el
+ * intervalo está vacío y count queda en 0.
+ *
+ * @param [in]  in_root   es el nodo raíz original del árbol
+ * @param [in]  low       límite inferior (incluido)
+ * @param [in]  high      límite superior (excluido)
+ * @param [out] count     cantidad de valores en el intervalo
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_range_count(
+  struct avl_node  *in_root,
+  float             low,
+  float             high,
+  int              *count);
+
+
+/**
+ * avl_range_scan
+ * Visita en orden creciente los nodos con valor en [low, high), sin recorrer
+ * el resto del árbol: O(log n + k) para k valores en el intervalo.
+ *
+ * @param [in]  in_root   es el nodo raíz original del árbol
+ * @param [in]  low       límite inferior (incluido)
+ * @param [in]  high      límite superior (excluido)
+ * @param [in]  visit     función llamada con cada nodo del intervalo
+ * @param [in]  context   puntero del usuario entregado a visit
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_range_scan(
+  struct avl_node  *in_root,
+  float             low,
+  float             high,
+  avl_visitor       visit,
+  void             *context);
+
+
+/**
+ * avl_next
+ * Obtiene el nodo siguiente en orden creciente usando los punteros al padre,
+ * sin recursión ni memoria extra. Recorrer todo el árbol desde avl_min_get
+ * cuesta O(1) amortizado por nodo. Un nodo sigue siendo un cursor válido
+ * mientras no sea eliminado, aunque se agreguen o eliminen otros valores.
+ *
+ * @param [in]  node       es el nodo actual
+ * @param [out] next_node  es el nodo siguiente
+ *
+ * @returns error_code    AVL_OUT_OF_RANGE si node es el último nodo
+ */
+int avl_next(
+  struct avl_node  *node,
+  struct avl_node **next_node);
+
+
+/**
+ * avl_prev
+ * Obtiene el nodo anterior en orden creciente, para recorridos en reversa
+ * desde avl_max_get.
+ *
+ * @param [in]  node       es el nodo actual
+ * @param [out] prev_node  es el nodo anterior
+ *
+ * @returns error_code    AVL_OUT_OF_RANGE si node es el primer nodo
+ */
+int avl_prev(
+  struct avl_node  *node,
+  struct avl_node **prev_node);
+
+
+/**
+ * avl_traverse
+ * Visita todos los nodos del árbol en el orden pedido. Pre-orden y en orden
+ * usan una pila acotada por la altura; por niveles usa una cola del ancho
+ * del árbol; las variantes de Morris no usan memoria extra, pero modifican
+ * enlaces durante el recorrido, así que visit no debe leer los hijos ni
+ * modificar el árbol.
+ *
+ * @param [in]  in_root   es el nodo raíz original del árbol
+ * @param [in]  order     orden de recorrido (avl_traversal_order)
+ * @param [in]  visit     función llamada con cada nodo
+ * @param [in]  context   puntero del usuario entregado a visit
+ *
+ * @returns error_code    un código de error indicando el éxito o error
+ *                        de la función
+ */
+int avl_traverse(
+  struct avl_node  *in_root,
+  int               order,
+  avl_visitor       visit,
+  void             *context);
+
+
 /**
  * avl_print_nodes
  * Se imprimen los nodos del árbol en terminal.
@@ -0,0 +1,437 @@
+#include "AVL_compact.hpp"
+#include <algorithm>
+
+
+using namespace std;
+
+
+
+// Stores the left child index of a node.
+static void set_lc(
+  struct avl_compact_node &node,
+  uint32_t                 index){
+    node.lc_index=index;
+}
+
+// Stores the right child index of a node, keeping its balance bits.
+static void set_rc(
+  struct avl_compact_node &node,
+  uint32_t                 index){
+    node.rc_bal=(node.rc_bal & ~AVL_COMPACT_INDEX_MASK) | index;
+}
+
+// Stores the balance factor of a node, keeping its right child index.
+static void set_balance(
+  struct avl_compact_node &node,
+  int                      balance){
+    uint32_t bits=(balance==1) ? 1u : ((balance==-1) ? 2u : 0u);
+    node.rc_bal=(node.rc_bal & AVL_COMPACT_INDEX_MASK) |
+                (bits << AVL_COMPACT_BALANCE_SHIFT);
+}
+
+// Links child under path[depth] on side dir[depth], or as the root when
+// depth is negative.
+static void set_link(
+  struct avl_compact_tree *tree,
+  const uint32_t          *path,
+  const int               *dir,
+  int                      depth,
+  uint32_t                 child){
+
+    if (depth<0){
+      tree->root=child;
+    }
+    else if (dir[depth]==0){
+      set_lc(tree->nodes[path[depth]],child);
+    }
+    else {
+      set_rc(tree->nodes[path[depth]],child);
+    }
+}
+
+// Takes a node from the free list or from the end of the array, growing the
+// array when it is full.
+static int alloc_node(
+  struct avl_compact_tree *tree,
+  float                    value,
+  uint32_t                *index){
+
+    // Reuse removed positions first.
+    if (tree->free_list!=AVL_COMPACT_NIL){
+      *index=tree->free_list;
+      tree->free_list=tree->nodes[*index].lc_index;
+    }
+    else {
+      // Indices must stay below the NIL marker.
+      if (tree->used>=AVL_COMPACT_NIL){
+        return AVL_OUT_OF_RANGE;
+      }
+
+      // Double the array, indices remain valid after the copy.
+      if (tree->used==tree->capacity){
+        uint64_t grown=static_cast<uint64_t>(tree->capacity)*2;
+        uint32_t new_capacity=static_cast<uint32_t>(
+          min<uint64_t>(max<uint64_t>(grown,16),AVL_COMPACT_NIL));
+        struct avl_compact_node *nodes=new struct avl_compact_node[new_capacity];
+        copy(tree->nodes,tree->nodes+tree->used,nodes);
+        delete[] tree->nodes;
+        tree->nodes=nodes;
+        tree->capacity=new_capacity;
+      }
+      *index=tree->used;
+      tree->used++;
+    }
+
+    // Initially no children and balanced, use value given.
+    tree->nodes[*index].value=value;
+    tree->nodes[*index].lc_index=AVL_COMPACT_NIL;
+    tree->nodes[*index].rc_bal=AVL_COMPACT_NIL;
+    tree->size++;
+
+    return AVL_SUCCESS;
+}
+
+// Pushes a node position on the free list.
+static void free_node(
+  struct avl_compact_tree *tree,
+  uint32_t                 index){
+    tree->nodes[index].lc_index=tree->free_list;
+    tree->free_list=index;
+    tree->size--;
+}
+
+// Restores the balance of node p whose (not stored) balance factor is +2 or
+// -2. Returns the new subtree root and whether the subtree height dropped.
+static uint32_t rebalance(
+  struct avl_compact_tree *tree,
+  uint32_t                 p,
+  int                      balance,
+  int                     *height_dropped){
+
+    struct avl_compact_node *nodes=tree->nodes;
+
+    // Left heavy.
+    if (balance>1){
+      uint32_t l=avl_compact_lc(nodes[p]);
+      int l_balance=avl_compact_balance(nodes[l]);
+
+      // Left Left Case: right rotation.
+      if (l_balance>=0){
+        set_lc(nodes[p],avl_compact_rc(nodes[l]));
+        set_rc(nodes[l],p);
+        set_balance(nodes[p],(l_balance==0) ? 1 : 0);
+        set_balance(nodes[l],(l_balance==0) ? -1 : 0);
+        *height_dropped=(l_balance!=0);
+        return l;
+      }
+
+      // Left Right Case: left rotation on child, then right rotation.
+      uint32_t g=avl_compact_rc(nodes[l]);
+      int g_balance=avl_compact_balance(nodes[g]);
+      set_rc(nodes[l],avl_compact_lc(nodes[g]));
+      set_lc(nodes[p],avl_compact_rc(nodes[g]));
+      set_lc(nodes[g],l);
+      set_rc(nodes[g],p);
+      set_balance(nodes[l],(g_balance==-1) ? 1 : 0);
+      set_balance(nodes[p],(g_balance==1) ? -1 : 0);
+      set_balance(nodes[g],0);
+      *height_dropped=1;
+      return g;
+    }
+
+    // Right heavy.
+    uint32_t r=avl_compact_rc(nodes[p]);
+    int r_balance=avl_compact_balance(nodes[r]);
+
+    // Right Right Case: left rotation.
+    if (r_balance<=0){
+      set_rc(nodes[p],avl_compact_lc(nodes[r]));
+      set_lc(nodes[r],p);
+      set_balance(nodes[p],(r_balance==0) ? -1 : 0);
+      set_balance(nodes[r],(r_balance==0) ? 1 : 0);
+      *height_dropped=(r_balance!=0);
+      return r;
+    }
+
+    // Right Left Case: right rotation on child, then left rotation.
+    uint32_t g=avl_compact_lc(nodes[r]);
+    int g_balance=avl_compact_balance(nodes[g]);
+    set_lc(nodes[r],avl_compact_rc(nodes[g]));
+    set_rc(nodes[p],avl_compact_lc(nodes[g]));
+    set_lc(nodes[g],p);
+    set_rc(nodes[g],r);
+    set_balance(nodes[r],(g_balance==1) ? -1 : 0);
+    set_balance(nodes[p],(g_balance==-1) ? 1 : 0);
+    set_balance(nodes[g],0);
+    *height_dropped=1;
+    return g;
+}
+
+
+int avl_compact_init(
+  struct avl_compact_tree *tree,
+  uint32_t                 capacity){
+
+    // Identify invalid parameters and return.
+    if (tree==nullptr || capacity>=AVL_COMPACT_NIL){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Reserve the initial array, it grows on demand.
+    tree->nodes=(capacity>0) ? new struct avl_compact_node[capacity] : nullptr;
+    tree->capacity=capacity;
+    tree->used=0;
+    tree->root=AVL_COMPACT_NIL;
+    tree->free_list=AVL_COMPACT_NIL;
+    tree->size=0;
+
+    return AVL_SUCCESS;
+
+}
+
+void avl_compact_free(
+  struct avl_compact_tree *tree){
+
+    // The whole tree lives in one array.
+    delete[] tree->nodes;
+    tree->nodes=nullptr;
+    tree->capacity=0;
+    tree->used=0;
+    tree->root=AVL_COMPACT_NIL;
+    tree->free_list=AVL_COMPACT_NIL;
+    tree->size=0;
+
+}
+
+int avl_compact_create(
+  float                   *in_number_list,
+  int                      list_size,
+  struct avl_compact_tree *tree){
+
+    // Identify invalid list sizes and return.
+    if (list_size<1){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Add every list element to the tree.
+    for (int index = 0; index < list_size; index++){
+      int status=avl_compact_add(in_number_list[index],tree);
+      if (status!=AVL_SUCCESS){
+        return status;
+      }
+    }
+
+    return AVL_SUCCESS;
+
+}
+
+int avl_compact_add(
+  float                    num,
+  struct avl_compact_tree *tree){
+
+    uint32_t path[AVL_MAX_HEIGHT];
+    int dir[AVL_MAX_HEIGHT];
+    int depth=0;
+    uint32_t current=tree->root;
+
+    // Descend recording the path.
+    while (current!=AVL_COMPACT_NIL){
+      const struct avl_compact_node &node=tree->nodes[current];
+      if (num < node.value){
+        dir[depth]=0;
+        path[depth++]=current;
+        current=avl_compact_lc(node);
+      }
+      else if (num > node.value){
+        dir[depth]=1;
+        path[depth++]=current;
+        current=avl_compact_rc(node);
+      }
+      else {
+        // Ignore repeated element.
+        return AVL_SUCCESS;
+      }
+    }
+
+    // Create and link the new leaf.
+    uint32_t leaf;
+    int status=alloc_node(tree,num,&leaf);
+    if (status!=AVL_SUCCESS){
+      return status;
+    }
+    set_link(tree,path,dir,depth-1,leaf);
+
+    // Walk back up while the subtree height keeps growing.
+    for (int index = depth-1; index >= 0; index--){
+      uint32_t p=path[index];
+      int balance=avl_compact_balance(tree->nodes[p])+((dir[index]==0) ? 1 : -1);
+
+      // Height unchanged, nothing else to update.
+      if (balance==0){
+        set_balance(tree->nodes[p],0);
+        break;
+      }
+
+      // Height grew by one, keep going up.
+      if (balance==1 || balance==-1){
+        set_balance(tree->nodes[p],balance);
+        continue;
+      }
+
+      // A rotation restores the previous height.
+      int height_dropped;
+      uint32_t top=rebalance(tree,p,balance,&height_dropped);
+      set_link(tree,path,dir,index-1,top);
+      break;
+    }
+
+    return AVL_SUCCESS;
+
+}
+
+int avl_compact_remove(
+  float                    num,
+  struct avl_compact_tree *tree){
+
+    uint32_t path[AVL_MAX_HEIGHT];
+    int dir[AVL_MAX_HEIGHT];
+    int depth=0;
+    uint32_t current=tree->root;
+
+    //if empty then avl is empty or doesnt exist.
+    if (current==AVL_COMPACT_NIL){
+      return AVL_NOT_FOUND;
+    }
+
+    // Descend recording the path.
+    while (current!=AVL_COMPACT_NIL && num!=tree->nodes[current].value){
+      dir[depth]=(num < tree->nodes[current].value) ? 0 : 1;
+      path[depth++]=current;
+      current=(dir[depth-1]==0) ? avl_compact_lc(tree->nodes[current]) :
+                                  avl_compact_rc(tree->nodes[current]);
+    }
+
+    // Value is not part of the tree.
+    if (current==AVL_COMPACT_NIL){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    uint32_t removed=current;
+    uint32_t replacement;
+    if (avl_compact_lc(tree->nodes[current])!=AVL_COMPACT_NIL &&
+        avl_compact_rc(tree->nodes[current])!=AVL_COMPACT_NIL){
+
+      // Two children: take the value of the right subtree minimum and remove
+      // that node instead.
+      dir[depth]=1;
+      path[depth++]=current;
+      removed=avl_compact_rc(tree->nodes[current]);
+      while (avl_compact_lc(tree->nodes[removed])!=AVL_COMPACT_NIL){
+        dir[depth]=0;
+        path[depth++]=removed;
+        removed=avl_compact_lc(tree->nodes[removed]);
+      }
+      tree->nodes[current].value=tree->nodes[removed].value;
+      replacement=avl_compact_rc(tree->nodes[removed]);
+    }
+    else {
+      // Then the only child (or nothing) will remplace the node.
+      replacement=(avl_compact_lc(tree->nodes[current])!=AVL_COMPACT_NIL) ?
+                    avl_compact_lc(tree->nodes[current]) :
+                    avl_compact_rc(tree->nodes[current]);
+    }
+    set_link(tree,path,dir,depth-1,replacement);
+    free_node(tree,removed);
+
+    // Walk back up while the subtree height keeps shrinking.
+    for (int index = depth-1; index >= 0; index--){
+      uint32_t p=path[index];
+      int balance=avl_compact_balance(tree->nodes[p])+((dir[index]==0) ? -1 : 1);
+
+      // Height unchanged, nothing else to update.
+      if (balance==1 || balance==-1){
+        set_balance(tree->nodes[p],balance);
+        break;
+      }
+
+      // Height dropped by one, keep going up.
+      if (balance==0){
+        set_balance(tree->nodes[p],0);
+        continue;
+      }
+
+      // Rotate, stop unless the rotation also dropped the height.
+      int height_dropped;
+      uint32_t top=rebalance(tree,p,balance,&height_dropped);
+      set_link(tree,path,dir,index-1,top);
+      if (!height_dropped){
+        break;
+      }
+    }
+
+    return AVL_SUCCESS;
+
+}
+
+int avl_compact_search(
+  float                          num,
+  const struct avl_compact_tree *tree,
+  uint32_t                      *found_index){
+
+  //if empty then avl is empty or doesnt exist.
+  if (tree->root==AVL_COMPACT_NIL){
+    return AVL_NOT_FOUND;
+  }
+
+  // Descend until the value is found or a leaf is passed.
+  uint32_t current=tree->root;
+  while (current!=AVL_COMPACT_NIL){
+    const struct avl_compact_node &node=tree->nodes[current];
+    if (num < node.value){
+      current=avl_compact_lc(node);
+    }
+    else if (num > node.value){
+      current=avl_compact_rc(node);
+    }
+    else {
+      *found_index=current;
+      return AVL_SUCCESS;
+    }
+  }
+
+  return AVL_OUT_OF_RANGE;
+}
+
+int avl_compact_max_get(
+  const struct avl_compact_tree *tree,
+  uint32_t                      *max_index){
+
+  if (tree->root==AVL_COMPACT_NIL){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  // Follow the right spine.
+  uint32_t current=tree->root;
+  while (avl_compact_rc(tree->nodes[current])!=AVL_COMPACT_NIL){
+    current=avl_compact_rc(tree->nodes[current]);
+  }
+  *max_index=current;
+  return AVL_SUCCESS;
+}
+
+int avl_compact_min_get(
+  const struct avl_compact_tree *tree,
+  uint32_t                      *min_index){
+
+  if (tree->root==AVL_COMPACT_NIL){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  // Follow the left spine.
+  uint32_t current=tree->root;
+  while (avl_compact_lc(tree->nodes[current])!=AVL_COMPACT_NIL){
+    current=avl_compact_lc(tree->nodes[current]);
+  }
+  *min_index=current;
+  return AVL_SUCCESS;
+}
@@ -0,0 +1,885 @@
+#include "AVL_concurrent.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+using namespace std;
+
+
+
+// Version bits of a node, every finished rotation adds 4.
+static const uint64_t VERSION_SHRINKING=1;
+static const uint64_t VERSION_UNLINKED=2;
+
+// Internal status: the caller must retry from its own node.
+static const int RETRY=1;
+
+// Node conditions, positive values are the height the node should have.
+static const int CONDITION_UNLINK=-1;
+static const int CONDITION_REBALANCE=-2;
+static const int CONDITION_NOTHING=-3;
+
+
+// Creates a present leaf.
+static struct avl_cnode *new_cnode(
+  float             value,
+  struct avl_cnode *parent){
+    struct avl_cnode *node=new struct avl_cnode;
+    node->lc_node.store(nullptr);
+    node->rc_node.store(nullptr);
+    node->parent.store(parent);
+    node->value=value;
+    node->present.store(true);
+    node->height.store(1);
+    node->version.store(0);
+    node->retired_next=nullptr;
+    return node;
+}
+
+// Height of a possibly empty subtree.
+static int height(
+  struct avl_cnode *node){
+    return (node==nullptr) ? 0 : node->height.load();
+}
+
+// Child on the side given by dir (negative left, positive right).
+static struct avl_cnode *child(
+  struct avl_cnode *node,
+  int               dir){
+    return (dir<0) ? node->lc_node.load() : node->rc_node.load();
+}
+
+// Links a child on the side given by dir.
+static void set_child(
+  struct avl_cnode *node,
+  int               dir,
+  struct avl_cnode *new_child){
+    if (dir<0){
+      node->lc_node.store(new_child);
+    }
+    else {
+      node->rc_node.store(new_child);
+    }
+}
+
+// Side of node where num lives, 0 if node holds it.
+static int compare(
+  float             num,
+  struct avl_cnode *node){
+    return (num<node->value) ? -1 : ((num>node->value) ? 1 : 0);
+}
+
+static bool is_unlinked(
+  uint64_t version){
+    return (version & VERSION_UNLINKED)!=0;
+}
+
+static bool is_shrinking_or_unlinked(
+  uint64_t version){
+    return (version & (VERSION_SHRINKING | VERSION_UNLINKED))!=0;
+}
+
+static uint64_t begin_change(
+  uint64_t version){
+    return version | VERSION_SHRINKING;
+}
+
+static uint64_t end_change(
+  uint64_t version){
+    return (version | VERSION_SHRINKING | VERSION_UNLINKED)+1;
+}
+
+// Spins until the rotation seen in version finishes. Readers never take
+// locks, rotations only hold them for a few stores.
+static void wait_shrink(
+  struct avl_cnode *node,
+  uint64_t          version){
+    if ((version & VERSION_SHRINKING)==0){
+      return;
+    }
+    while (node->version.load()==version){
+      this_thread::yield();
+    }
+}
+
+// Pushes an unlinked node on the retired list of the current epoch. The
+// caller is inside an operation, so the epoch can't pass e+1 meanwhile.
+static void retire(
+  struct avl_concurrent_tree *tree,
+  struct avl_cnode           *node){
+    std::atomic<struct avl_cnode *> &list=tree->retired[tree->epoch.load()%3];
+    struct avl_cnode *head=list.load();
+    do {
+      node->retired_next=head;
+    } while (!list.compare_exchange_weak(head,node));
+}
+
+// Frees a retired list, returns how many nodes it held.
+static int free_retired(
+  struct avl_cnode *node){
+    int freed=0;
+    while (node!=nullptr){
+      struct avl_cnode *next=node->retired_next;
+      delete node;
+      node=next;
+      freed++;
+    }
+    return freed;
+}
+
+// Enters an operation and returns its epoch. The epoch is read again after
+// counting in, so an advance never misses an operation of the old epoch.
+static uint64_t enter_epoch(
+  struct avl_concurrent_tree *tree){
+    while (true){
+      uint64_t epoch=tree->epoch.load();
+      tree->active[epoch%2].fetch_add(1);
+      if (tree->epoch.load()==epoch){
+        return epoch;
+      }
+      tree->active[epoch%2].fetch_sub(1);
+    }
+}
+
+// Leaves an operation of the given epoch. If nothing from epoch-1 is still
+// running, moves to epoch+1 and frees the nodes retired in epoch-1: every
+// operation that could have seen them is over. The caller still counts as
+// running, so nobody advances to epoch+2 and reuses that list meanwhile.
+static void exit_epoch(
+  struct avl_concurrent_tree *tree,
+  uint64_t                    epoch){
+    if ((tree->retired[epoch%3].load()!=nullptr ||
+         tree->retired[(epoch+2)%3].load()!=nullptr) &&
+        tree->active[(epoch+1)%2].load()==0){
+      uint64_t expected=epoch;
+      if (tree->epoch.compare_exchange_strong(expected,epoch+1)){
+        free_retired(tree->retired[(epoch+2)%3].exchange(nullptr));
+      }
+    }
+    tree->active[epoch%2].fetch_sub(1);
+}
+
+
+// Decides what node needs. The read isn't atomic, but whoever changes a
+// node also repairs it, so a wrong answer is always fixed by someone.
+static int node_condition(
+  struct avl_cnode *node){
+    struct avl_cnode *left=node->lc_node.load();
+    struct avl_cnode *right=node->rc_node.load();
+    if ((left==nullptr || right==nullptr) && !node->present.load()){
+      return CONDITION_UNLINK;
+    }
+
+    int node_height=node->height.load();
+    int left_height=height(left);
+    int right_height=height(right);
+    int balance=left_height-right_height;
+    if (balance<-1 || balance>1){
+      return CONDITION_REBALANCE;
+    }
+    int new_height=1+max(left_height,right_height);
+    return (node_height!=new_height) ? new_height : CONDITION_NOTHING;
+}
+
+// Fixes the height of a locked node. Returns the node that still needs
+// work, or nullptr.
+static struct avl_cnode *fix_height(
+  struct avl_cnode *node){
+    int condition=node_condition(node);
+    if (condition==CONDITION_REBALANCE || condition==CONDITION_UNLINK){
+      return node;
+    }
+    if (condition==CONDITION_NOTHING){
+      return nullptr;
+    }
+    node->height.store(condition);
+    return node->parent.load();
+}
+
+// Splices out a locked node with at most one child from its locked parent.
+static bool attempt_unlink(
+  struct avl_concurrent_tree *tree,
+  struct avl_cnode           *parent,
+  struct avl_cnode           *node){
+
+    struct avl_cnode *parent_left=parent->lc_node.load();
+    struct avl_cnode *parent_right=parent->rc_node.load();
+    if (parent_left!=node && parent_right!=node){
+      return false;
+    }
+
+    struct avl_cnode *left=node->lc_node.load();
+    struct avl_cnode *right=node->rc_node.load();
+    if (left!=nullptr && right!=nullptr){
+      return false;
+    }
+
+    struct avl_cnode *splice=(left!=nullptr) ? left : right;
+    if (parent_left==node){
+      parent->lc_node.store(splice);
+    }
+    else {
+      parent->rc_node.store(splice);
+    }
+    if (splice!=nullptr){
+      splice->parent.store(parent);
+    }
+    node->version.store(VERSION_UNLINKED);
+    node->present.store(false);
+    retire(tree,node);
+    return true;
+}
+
+// Links a rotated subtree root where node was under parent.
+static void replace_child(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *new_node){
+    if (parent->lc_node.load()==node){
+      parent->lc_node.store(new_node);
+    }
+    else {
+      parent->rc_node.store(new_node);
+    }
+    new_node->parent.store(parent);
+}
+
+// Right rotation of node over its left child. parent, node and left are
+// locked. Returns the deepest node that still needs work.
+static struct avl_cnode *rotate_right(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *left,
+  int               right_height,
+  int               left_left_height,
+  struct avl_cnode *left_right,
+  int               left_right_height){
+
+    uint64_t node_version=node->version.load();
+    node->version.store(begin_change(node_version));
+
+    node->lc_node.store(left_right);
+    if (left_right!=nullptr){
+      left_right->parent.store(node);
+    }
+    left->rc_node.store(node);
+    node->parent.store(left);
+    replace_child(parent,node,left);
+
+    int node_height=1+max(left_right_height,right_height);
+    node->height.store(node_height);
+    left->height.store(1+max(left_left_height,node_height));
+    node->version.store(end_change(node_version));
+
+    // node may still be unbalanced or an unneeded routing node.
+    int balance=left_right_height-right_height;
+    if (balance<-1 || balance>1){
+      return node;
+    }
+    if ((left_right==nullptr || right_height==0) && !node->present.load()){
+      return node;
+    }
+
+    // Same checks for the new subtree root.
+    balance=left_left_height-node_height;
+    if (balance<-1 || balance>1){
+      return left;
+    }
+    if (left_left_height==0 && !left->present.load()){
+      return left;
+    }
+    return fix_height(parent);
+}
+
+// Left rotation of node over its right child. parent, node and right are
+// locked. Returns the deepest node that still needs work.
+static struct avl_cnode *rotate_left(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  int               left_height,
+  struct avl_cnode *right,
+  struct avl_cnode *right_left,
+  int               right_left_height,
+  int               right_right_height){
+
+    uint64_t node_version=node->version.load();
+    node->version.store(begin_change(node_version));
+
+    node->rc_node.store(right_left);
+    if (right_left!=nullptr){
+      right_left->parent.store(node);
+    }
+    right->lc_node.store(node);
+    node->parent.store(right);
+    replace_child(parent,node,right);
+
+    int node_height=1+max(left_height,right_left_height);
+    node->height.store(node_height);
+    right->height.store(1+max(node_height,right_right_height));
+    node->version.store(end_change(node_version));
+
+    int balance=right_left_height-left_height;
+    if (balance<-1 || balance>1){
+      return node;
+    }
+    if ((right_left==nullptr || left_height==0) && !node->present.load()){
+      return node;
+    }
+
+    balance=right_right_height-node_height;
+    if (balance<-1 || balance>1){
+      return right;
+    }
+    if (right_right_height==0 && !right->present.load()){
+      return right;
+    }
+    return fix_height(parent);
+}
+
+// Left-Right double rotation. parent, node, left and left_right are locked.
+static struct avl_cnode *rotate_right_over_left(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *left,
+  int               right_height,
+  int               left_left_height,
+  struct avl_cnode *left_right,
+  int               left_right_left_height){
+
+    uint64_t node_version=node->version.load();
+    uint64_t left_version=left->version.load();
+    struct avl_cnode *inner_left=left_right->lc_node.load();
+    struct avl_cnode *inner_right=left_right->rc_node.load();
+    int inner_right_height=height(inner_right);
+
+    node->version.store(begin_change(node_version));
+    left->version.store(begin_change(left_version));
+
+    node->lc_node.store(inner_right);
+    if (inner_right!=nullptr){
+      inner_right->parent.store(node);
+    }
+    left->rc_node.store(inner_left);
+    if (inner_left!=nullptr){
+      inner_left->parent.store(left);
+    }
+    left_right->lc_node.store(left);
+    left->parent.store(left_right);
+    left_right->rc_node.store(node);
+    node->parent.store(left_right);
+    replace_child(parent,node,left_right);
+
+    int node_height=1+max(inner_right_height,right_height);
+    node->height.store(node_height);
+    int left_height=1+max(left_left_height,left_right_left_height);
+    left->height.store(left_height);
+    left_right->height.store(1+max(left_height,node_height));
+
+    node->version.store(end_change(node_version));
+    left->version.store(end_change(left_version));
+
+    int balance=inner_right_height-right_height;
+    if (balance<-1 || balance>1){
+      return node;
+    }
+    if ((inner_right==nullptr || right_height==0) && !node->present.load()){
+      return node;
+    }
+    // left may have become a routing node with a missing child.
+    if ((left_left_height==0 || inner_left==nullptr) && !left->present.load()){
+      return left;
+    }
+    balance=left_height-node_height;
+    if (balance<-1 || balance>1){
+      return left_right;
+    }
+    return fix_height(parent);
+}
+
+// Right-Left double rotation. parent, node, right and right_left are locked.
+static struct avl_cnode *rotate_left_over_right(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  int               left_height,
+  struct avl_cnode *right,
+  struct avl_cnode *right_left,
+  int               right_right_height,
+  int               right_left_right_height){
+
+    uint64_t node_version=node->version.load();
+    uint64_t right_version=right->version.load();
+    struct avl_cnode *inner_left=right_left->lc_node.load();
+    struct avl_cnode *inner_right=right_left->rc_node.load();
+    int inner_left_height=height(inner_left);
+
+    node->version.store(begin_change(node_version));
+    right->version.store(begin_change(right_version));
+
+    node->rc_node.store(inner_left);
+    if (inner_left!=nullptr){
+      inner_left->parent.store(node);
+    }
+    right->lc_node.store(inner_right);
+    if (inner_right!=nullptr){
+      inner_right->parent.store(right);
+    }
+    right_left->rc_node.store(right);
+    right->parent.store(right_left);
+    right_left->lc_node.store(node);
+    node->parent.store(right_left);
+    replace_child(parent,node,right_left);
+
+    int node_height=1+max(left_height,inner_left_height);
+    node->height.store(node_height);
+    int right_height=1+max(right_left_right_height,right_right_height);
+    right->height.store(right_height);
+    right_left->height.store(1+max(node_height,right_height));
+
+    node->version.store(end_change(node_version));
+    right->version.store(end_change(right_version));
+
+    int balance=inner_left_height-left_height;
+    if (balance<-1 || balance>1){
+      return node;
+    }
+    if ((inner_left==nullptr || left_height==0) && !node->present.load()){
+      return node;
+    }
+    if ((right_right_height==0 || inner_right==nullptr) && !right->present.load()){
+      return right;
+    }
+    balance=right_height-node_height;
+    if (balance<-1 || balance>1){
+      return right_left;
+    }
+    return fix_height(parent);
+}
+
+static struct avl_cnode *rebalance_to_left(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *right,
+  int               left_height);
+
+// The left side of node is too tall. parent and node are locked.
+static struct avl_cnode *rebalance_to_right(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *left,
+  int               right_height){
+
+    lock_guard<mutex> left_guard(left->lock);
+
+    // Someone already fixed it, check node again.
+    if (left->height.load()-right_height<=1){
+      return node;
+    }
+
+    struct avl_cnode *left_right=left->rc_node.load();
+    int left_left_height=height(left->lc_node.load());
+    int left_right_height=height(left_right);
+    if (left_left_height>=left_right_height){
+      return rotate_right(parent,node,left,right_height,left_left_height,
+                          left_right,left_right_height);
+    }
+
+    {
+      lock_guard<mutex> left_right_guard(left_right->lock);
+      left_right_height=left_right->height.load();
+      if (left_left_height>=left_right_height){
+        return rotate_right(parent,node,left,right_height,left_left_height,
+                            left_right,left_right_height);
+      }
+
+      // Double rotate only if left ends up balanced.
+      int left_right_left_height=height(left_right->lc_node.load());
+      int balance=left_left_height-left_right_left_height;
+      if (balance>=-1 && balance<=1){
+        return rotate_right_over_left(parent,node,left,right_height,
+                                      left_left_height,left_right,
+                                      left_right_left_height);
+      }
+    }
+
+    // Fix left first, node is balanced afterwards if still needed.
+    return rebalance_to_left(node,left,left_right,left_left_height);
+}
+
+// The right side of node is too tall. parent and node are locked.
+static struct avl_cnode *rebalance_to_left(
+  struct avl_cnode *parent,
+  struct avl_cnode *node,
+  struct avl_cnode *right,
+  int               left_height){
+
+    lock_guard<mutex> right_guard(right->lock);
+
+    if (left_height-right->height.load()>=-1){
+      return node;
+    }
+
+    struct avl_cnode *right_left=right->lc_node.load();
+    int right_left_height=height(right_left);
+    int right_right_height=height(right->rc_node.load());
+    if (right_right_height>=right_left_height){
+      return rotate_left(parent,node,left_height,right,right_left,
+                         right_left_height,right_right_height);
+    }
+
+    {
+      lock_guard<mutex> right_left_guard(right_left->lock);
+      right_left_height=right_left->height.load();
+      if (right_right_height>=right_left_height){
+        return rotate_left(parent,node,left_height,right,right_left,
+                           right_left_height,right_right_height);
+      }
+
+      int right_left_right_height=height(right_left->rc_node.load());
+      int balance=right_right_height-right_left_right_height;
+      if (balance>=-1 && balance<=1){
+        return rotate_left_over_right(parent,node,left_height,right,
+                                      right_left,right_right_height,
+                                      right_left_right_height);
+      }
+    }
+
+    return rebalance_to_right(node,right,right_left,right_right_height);
+}
+
+// Unlinks, rotates or fixes the height of a locked node under its locked
+// parent. Returns the node that still needs work, or nullptr.
+static struct avl_cnode *rebalance(
+  struct avl_concurrent_tree *tree,
+  struct avl_cnode           *parent,
+  struct avl_cnode           *node){
+
+    struct avl_cnode *left=node->lc_node.load();
+    struct avl_cnode *right=node->rc_node.load();
+    if ((left==nullptr || right==nullptr) && !node->present.load()){
+      if (attempt_unlink(tree,parent,node)){
+        return fix_height(parent);
+      }
+      return node;
+    }
+
+    int node_height=node->height.load();
+    int left_height=height(left);
+    int right_height=height(right);
+    int balance=left_height-right_height;
+    if (balance>1){
+      return rebalance_to_right(parent,node,left,right_height);
+    }
+    if (balance<-1){
+      return rebalance_to_left(parent,node,right,left_height);
+    }
+
+    int new_height=1+max(left_height,right_height);
+    if (new_height!=node_height){
+      node->height.store(new_height);
+      return fix_height(parent);
+    }
+    return nullptr;
+}
+
+// Repairs node and its ancestors after a change, one locked step at a time.
+// A rotation may damage several nodes but hands back only the deepest one,
+// so the rotated node and its parent are checked again once the deeper
+// repairs are over.
+static void fix_and_rebalance(
+  struct avl_concurrent_tree *tree,
+  struct avl_cnode           *node){
+
+    vector<struct avl_cnode *> deferred;
+    while (true){
+      if (node==nullptr || node->parent.load()==nullptr ||
+          is_unlinked(node->version.load())){
+        if (deferred.empty()){
+          return;
+        }
+        node=deferred.back();
+        deferred.pop_back();
+        continue;
+      }
+
+      int condition=node_condition(node);
+      if (condition==CONDITION_NOTHING){
+        node=nullptr;
+        continue;
+      }
+
+      if (condition!=CONDITION_UNLINK && condition!=CONDITION_REBALANCE){
+        lock_guard<mutex> node_guard(node->lock);
+        node=fix_height(node);
+        continue;
+      }
+
+      struct avl_cnode *parent=node->parent.load();
+      lock_guard<mutex> parent_guard(parent->lock);
+      if (!is_unlinked(parent->version.load()) && node->parent.load()==parent){
+        lock_guard<mutex> node_guard(node->lock);
+        // An unlinked node may still point to its old children.
+        if (is_unlinked(node->version.load())){
+          node=nullptr;
+          continue;
+        }
+        struct avl_cnode *next=rebalance(tree,parent,node);
+        if (next!=nullptr && next!=parent && next!=parent->parent.load()){
+          deferred.push_back(parent);
+          if (next!=node){
+            deferred.push_back(node);
+          }
+        }
+        node=next;
+      }
+    }
+}
+
+
+// Lock-free search below node, which was validated with node_version.
+static int attempt_get(
+  float             num,
+  struct avl_cnode *node,
+  int               dir,
+  uint64_t          node_version){
+
+    while (true){
+      struct avl_cnode *next=child(node,dir);
+      if (next==nullptr){
+        if (node->version.load()!=node_version){
+          return RETRY;
+        }
+        return AVL_OUT_OF_RANGE;
+      }
+
+      int next_dir=compare(num,next);
+      if (next_dir==0){
+        return next->present.load() ? AVL_SUCCESS : AVL_OUT_OF_RANGE;
+      }
+
+      uint64_t next_version=next->version.load();
+      if (is_shrinking_or_unlinked(next_version)){
+        wait_shrink(next,next_version);
+        if (node->version.load()!=node_version){
+          return RETRY;
+        }
+      }
+      else if (next!=child(node,dir)){
+        if (node->version.load()!=node_version){
+          return RETRY;
+        }
+      }
+      else {
+        // next was really our child when we read its version.
+        if (node->version.load()!=node_version){
+          return RETRY;
+        }
+        int status=attempt_get(num,next,next_dir,next_version);
+        if (status!=RETRY){
+          return status;
+        }
+      }
+    }
+}
+
+// Adds or removes num at node, which holds it.
+static int attempt_node_update(
+  struct avl_concurrent_tree *tree,
+  bool                        present,
+  struct avl_cnode           *parent,
+  struct avl_cnode           *node){
+
+    if (!present){
+      if (!node->present.load()){
+        return AVL_OUT_OF_RANGE;
+      }
+
+      // With one child at most the node can be spliced out.
+      if (node->lc_node.load()==nullptr || node->rc_node.load()==nullptr){
+        struct avl_cnode *damaged;
+        {
+          lock_guard<mutex> parent_guard(parent->lock);
+          if (is_unlinked(parent->version.load()) ||
+              node->parent.load()!=parent){
+            return RETRY;
+          }
+          {
+            lock_guard<mutex> node_guard(node->lock);
+            if (!node->present.load()){
+              return AVL_OUT_OF_RANGE;
+            }
+            if (!attempt_unlink(tree,parent,node)){
+              return RETRY;
+            }
+          }
+          damaged=fix_height(parent);
+        }
+        fix_and_rebalance(tree,damaged);
+        return AVL_SUCCESS;
+      }
+    }
+
+    // Flip the flag in place, a removed node stays as a routing node.
+    lock_guard<mutex> node_guard(node->lock);
+    if (is_unlinked(node->version.load())){
+      return RETRY;
+    }
+    if (node->present.load()==present){
+      return present ? AVL_SUCCESS : AVL_OUT_OF_RANGE;
+    }
+    if (!present &&
+        (node->lc_node.load()==nullptr || node->rc_node.load()==nullptr)){
+      return RETRY;
+    }
+    node->present.store(present);
+    return AVL_SUCCESS;
+}
+
+// Optimistic descent for add and remove below node, which was validated
+// with node_version. Only the node being changed and its parent are locked.
+static int attempt_update(
+  struct avl_concurrent_tree *tree,
+  float                       num,
+  bool                        present,
+  struct avl_cnode           *parent,
+  struct avl_cnode           *node,
+  uint64_t                    node_version){
+
+    // The sentinel keeps the whole tree on its right.
+    int dir=(node==tree->holder) ? 1 : compare(num,node);
+    if (dir==0){
+      return attempt_node_update(tree,present,parent,node);
+    }
+
+    while (true){
+      struct avl_cnode *next=child(node,dir);
+      if (node->version.load()!=node_version){
+        return RETRY;
+      }
+
+      if (next==nullptr){
+        // num is not in the tree.
+        if (!present){
+          return (node==tree->holder) ? AVL_NOT_FOUND : AVL_OUT_OF_RANGE;
+        }
+
+        struct avl_cnode *damaged=nullptr;
+        bool inserted=false;
+        {
+          lock_guard<mutex> node_guard(node->lock);
+          if (node->version.load()!=node_version){
+            return RETRY;
+          }
+          // Lost a race with another insert, look at the new child.
+          if (child(node,dir)==nullptr){
+            set_child(node,dir,new_cnode(num,node));
+            damaged=fix_height(node);
+            inserted=true;
+          }
+        }
+        if (inserted){
+          fix_and_rebalance(tree,damaged);
+          return AVL_SUCCESS;
+        }
+      }
+      else {
+        uint64_t next_version=next->version.load();
+        if (is_shrinking_or_unlinked(next_version)){
+          wait_shrink(next,next_version);
+        }
+        else if (next==child(node,dir)){
+          if (node->version.load()!=node_version){
+            return RETRY;
+          }
+          int status=attempt_update(tree,num,present,node,next,next_version);
+          if (status!=RETRY){
+            return status;
+          }
+        }
+      }
+    }
+}
+
+// Frees a detached subtree.
+static void free_subtree(
+  struct avl_cnode *node){
+    while (node!=nullptr){
+      struct avl_cnode *right=node->rc_node.load();
+      free_subtree(node->lc_node.load());
+      delete node;
+      node=right;
+    }
+}
+
+void avl_concurrent_init(
+  struct avl_concurrent_tree *tree){
+    tree->holder=new_cnode(0,nullptr);
+    tree->epoch.store(0);
+    for (int index = 0; index < 2; index++){
+      tree->active[index].store(0);
+    }
+    for (int index = 0; index < 3; index++){
+      tree->retired[index].store(nullptr);
+    }
+}
+
+void avl_concurrent_free(
+  struct avl_concurrent_tree *tree){
+    avl_concurrent_reclaim(tree);
+    free_subtree(tree->holder);
+    tree->holder=nullptr;
+}
+
+int avl_concurrent_reclaim(
+  struct avl_concurrent_tree *tree){
+    int freed=0;
+    for (int index = 0; index < 3; index++){
+      freed+=free_retired(tree->retired[index].exchange(nullptr));
+    }
+    return freed;
+}
+
+int avl_concurrent_add(
+  float                       num,
+  struct avl_concurrent_tree *tree){
+    struct avl_cnode *holder=tree->holder;
+    uint64_t epoch=enter_epoch(tree);
+    int status;
+    do {
+      status=attempt_update(tree,num,true,nullptr,holder,holder->version.load());
+    } while (status==RETRY);
+    exit_epoch(tree,epoch);
+    return status;
+}
+
+int avl_concurrent_remove(
+  float                       num,
+  struct avl_concurrent_tree *tree){
+    struct avl_cnode *holder=tree->holder;
+    uint64_t epoch=enter_epoch(tree);
+    int status;
+    do {
+      status=attempt_update(tree,num,false,nullptr,holder,holder->version.load());
+    } while (status==RETRY);
+    exit_epoch(tree,epoch);
+    return status;
+}
+
+int avl_concurrent_search(
+  float                       num,
+  struct avl_concurrent_tree *tree){
+    struct avl_cnode *holder=tree->holder;
+
+    // Identify if the tree is empty.
+    if (holder->rc_node.load()==nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    uint64_t epoch=enter_epoch(tree);
+    int status;
+    do {
+      status=attempt_get(num,holder,1,holder->version.load());
+    } while (status==RETRY);
+    exit_epoch(tree,epoch);
+    return status;
+}
@@ -0,0 +1,143 @@
+#include "AVL_export.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+
+using namespace std;
+
+
+
+// Longest text a single value can take.
+static const size_t MAX_TEXT_LENGTH=32;
+
+// Formats value followed by a newline into text and returns its length.
+// Integral values skip printf, they are the common case and the slow one.
+static size_t format_value(
+  float  value,
+  char  *text){
+
+    if (value==truncf(value) && fabsf(value)<1e9f && !(value==0 && signbit(value))){
+      long integer=static_cast<long>(value);
+      char digits[16];
+      size_t count=0;
+      unsigned long magnitude=(integer<0) ? -static_cast<unsigned long>(integer) :
+                                            static_cast<unsigned long>(integer);
+      do {
+        digits[count++]=static_cast<char>('0'+magnitude%10);
+        magnitude/=10;
+      } while (magnitude>0);
+
+      size_t length=0;
+      if (integer<0){
+        text[length++]='-';
+      }
+      while (count>0){
+        text[length++]=digits[--count];
+      }
+      text[length++]='\n';
+      return length;
+    }
+
+    // Nine significant digits always round-trip a float.
+    return static_cast<size_t>(snprintf(text,MAX_TEXT_LENGTH,"%.9g\n",value));
+}
+
+int avl_writer_init(
+  struct avl_writer *writer,
+  int                fd,
+  int                format,
+  size_t             capacity){
+
+    // Identify invalid parameters and return.
+    if (fd<0 || capacity<MAX_TEXT_LENGTH ||
+        (format!=AVL_EXPORT_TEXT && format!=AVL_EXPORT_BINARY)){
+      return AVL_INVALID_PARAM;
+    }
+
+    writer->fd=fd;
+    writer->format=format;
+    writer->buffer=new char[capacity];
+    writer->capacity=capacity;
+    writer->used=0;
+    return AVL_SUCCESS;
+
+}
+
+int avl_writer_put(
+  struct avl_writer *writer,
+  float              value){
+
+    // Make room for the longest value.
+    if (writer->capacity-writer->used<MAX_TEXT_LENGTH){
+      int status=avl_writer_flush(writer);
+      if (status!=AVL_SUCCESS){
+        return status;
+      }
+    }
+
+    char *end=writer->buffer+writer->used;
+    if (writer->format==AVL_EXPORT_BINARY){
+      memcpy(end,&value,sizeof(value));
+      writer->used+=sizeof(value);
+    }
+    else {
+      writer->used+=format_value(value,end);
+    }
+    return AVL_SUCCESS;
+
+}
+
+int avl_writer_flush(
+  struct avl_writer *writer){
+
+    // write may take only part of the buffer or be interrupted.
+    size_t offset=0;
+    while (offset<writer->used){
+      ssize_t written=write(writer->fd,writer->buffer+offset,writer->used-offset);
+      if (written<0){
+        if (errno==EINTR){
+          continue;
+        }
+        return AVL_OUT_OF_RANGE;
+      }
+      offset+=static_cast<size_t>(written);
+    }
+    writer->used=0;
+    return AVL_SUCCESS;
+
+}
+
+void avl_writer_release(
+  struct avl_writer *writer){
+    delete[] writer->buffer;
+    writer->buffer=nullptr;
+    writer->capacity=0;
+    writer->used=0;
+}
+
+int avl_export(
+  struct avl_node *in_root,
+  int              order,
+  int              fd,
+  int              format){
+
+    struct avl_writer writer;
+    int status=avl_writer_init(&writer,fd,format,AVL_EXPORT_BUFFER_SIZE);
+    if (status!=AVL_SUCCESS){
+      return status;
+    }
+
+    status=avl_traverse(in_root,order,
+      [](struct avl_node *node, void *context) -> int {
+        return avl_writer_put(static_cast<struct avl_writer *>(context),node->value);
+      },&writer);
+    if (status==AVL_SUCCESS){
+      status=avl_writer_flush(&writer);
+    }
+    avl_writer_release(&writer);
+    return status;
+
+}
@@ -0,0 +1,315 @@
+#include "AVL_forest.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+
+using namespace std;
+
+
+
+// Index of the shard whose interval holds num: the last one whose lower
+// bound is not above num.
+static int route(
+  struct avl_forest *forest,
+  float              num){
+    int first=1;
+    int last=forest->shard_count;
+    while (first<last){
+      int middle=first+(last-first)/2;
+      if (forest->shards[middle].low.load()<=num){
+        first=middle+1;
+      }
+      else {
+        last=middle;
+      }
+    }
+    return first-1;
+}
+
+// Locks the shard that owns num. Bounds only move while every shard is
+// locked, so they are stable once the owner is held.
+static struct avl_shard *lock_owner(
+  struct avl_forest *forest,
+  float              num){
+    while (true){
+      int index=route(forest,num);
+      struct avl_shard *shard=&forest->shards[index];
+      shard->lock.lock();
+      bool owned=shard->low.load()<=num &&
+                 (index+1==forest->shard_count ||
+                  num<forest->shards[index+1].low.load());
+      if (owned){
+        return shard;
+      }
+      shard->lock.unlock();
+    }
+}
+
+// A shard is skewed when it holds many times the average. With few shards
+// that limit reaches the total, so it is capped at AVL_FOREST_MAX_SHARE.
+static bool is_skewed(
+  struct avl_forest *forest,
+  int                shard_size){
+    long total=forest->size.load();
+    if (forest->shard_count<2 || total<AVL_FOREST_MIN_REBALANCE){
+      return false;
+    }
+    long limit=min(AVL_FOREST_SKEW*total/forest->shard_count,
+                   static_cast<long>(AVL_FOREST_MAX_SHARE*total));
+    return shard_size>limit;
+}
+
+// Locks every shard, always in index order. Bounds move only while every
+// shard is locked.
+static void lock_all(
+  struct avl_forest *forest){
+    for (int index = 0; index < forest->shard_count; index++){
+      forest->shards[index].lock.lock();
+    }
+}
+
+static void unlock_all(
+  struct avl_forest *forest){
+    for (int index = forest->shard_count-1; index >= 0; index--){
+      forest->shards[index].lock.unlock();
+    }
+}
+
+// Rebuilds every shard from a slice of equal size and moves the bounds to
+// the first value of each slice. Every shard must be locked.
+static int rebuild_shards(
+  struct avl_forest *forest){
+
+    // Gather every value in order.
+    vector<float> values;
+    values.reserve(forest->size.load());
+    for (int index = 0; index < forest->shard_count; index++){
+      struct avl_node *node=nullptr;
+      if (avl_min_get(forest->shards[index].root,&node)==AVL_SUCCESS){
+        do {
+          values.push_back(node->value);
+        } while (avl_next(node,&node)==AVL_SUCCESS);
+      }
+    }
+
+    int total=static_cast<int>(values.size());
+    int status=AVL_SUCCESS;
+    for (int index = 0; index < forest->shard_count; index++){
+      struct avl_shard *shard=&forest->shards[index];
+      int first=static_cast<int>(static_cast<long>(total)*index/forest->shard_count);
+      int last=static_cast<int>(static_cast<long>(total)*(index+1)/forest->shard_count);
+
+      // Drop the old nodes at once and build the slice into a fresh pool.
+      avl_pool_release(&shard->pool);
+      avl_pool_init(&shard->pool,AVL_POOL_SLAB_SIZE);
+      shard->root=nullptr;
+      if (last>first){
+        status=avl_pool_build_sorted(&values[first],last-first,&shard->root,&shard->pool);
+      }
+      shard->size.store(last-first);
+
+      // Empty trailing shards get an empty interval.
+      if (index>0){
+        shard->low.store((first<total) ? values[first] :
+                         numeric_limits<float>::infinity());
+      }
+    }
+    return status;
+
+}
+
+int avl_forest_init(
+  struct avl_forest *forest,
+  int                shard_count,
+  float              low,
+  float              high){
+
+    // Identify invalid parameters and return.
+    if (shard_count<1 || !(low<high)){
+      return AVL_INVALID_PARAM;
+    }
+
+    forest->shards=new struct avl_shard[shard_count];
+    forest->shard_count=shard_count;
+    forest->size.store(0);
+
+    // Equal intervals, the first one is open to the left.
+    for (int index = 0; index < shard_count; index++){
+      struct avl_shard *shard=&forest->shards[index];
+      shard->root=nullptr;
+      avl_pool_init(&shard->pool,AVL_POOL_SLAB_SIZE);
+      shard->size.store(0);
+      shard->low.store((index==0) ? -numeric_limits<float>::infinity() :
+                       low+(high-low)*index/shard_count);
+    }
+    return AVL_SUCCESS;
+
+}
+
+void avl_forest_free(
+  struct avl_forest *forest){
+    for (int index = 0; index < forest->shard_count; index++){
+      avl_pool_release(&forest->shards[index].pool);
+    }
+    delete[] forest->shards;
+    forest->shards=nullptr;
+    forest->shard_count=0;
+    forest->size.store(0);
+}
+
+int avl_forest_add(
+  float              num,
+  struct avl_forest *forest){
+
+    // NaN belongs to no shard interval.
+    if (num!=num){
+      return AVL_INVALID_PARAM;
+    }
+
+    struct avl_shard *shard=lock_owner(forest,num);
+    int old_size=get_size(shard->root);
+    int status=avl_pool_node_add(num,&shard->root,&shard->pool);
+    int new_size=get_size(shard->root);
+    shard->size.store(new_size);
+    forest->size.fetch_add(new_size-old_size);
+    shard->lock.unlock();
+
+    // Spread the keys again when one shard takes most of them. Another
+    // writer may have done it while we waited for the locks.
+    if (status==AVL_SUCCESS && is_skewed(forest,new_size)){
+      lock_all(forest);
+      if (is_skewed(forest,shard->size.load())){
+        status=rebuild_shards(forest);
+      }
+      unlock_all(forest);
+    }
+    return status;
+
+}
+
+int avl_forest_remove(
+  float              num,
+  struct avl_forest *forest){
+
+    // NaN belongs to no shard interval.
+    if (num!=num){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Identify if the forest is empty.
+    if (forest->size.load()==0){
+      return AVL_NOT_FOUND;
+    }
+
+    struct avl_shard *shard=lock_owner(forest,num);
+    int status=avl_pool_node_remove(num,&shard->root,&shard->pool);
+    if (status==AVL_SUCCESS){
+      shard->size.store(get_size(shard->root));
+      forest->size.fetch_sub(1);
+    }
+    shard->lock.unlock();
+
+    // Other shards may hold values, the value is just missing.
+    return (status==AVL_NOT_FOUND) ? AVL_OUT_OF_RANGE : status;
+
+}
+
+int avl_forest_search(
+  float              num,
+  struct avl_forest *forest){
+
+    // NaN belongs to no shard interval.
+    if (num!=num){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Identify if the forest is empty.
+    if (forest->size.load()==0){
+      return AVL_NOT_FOUND;
+    }
+
+    struct avl_shard *shard=lock_owner(forest,num);
+    struct avl_node *found_node=nullptr;
+    int status=avl_search(num,&shard->root,&found_node);
+    shard->lock.unlock();
+    return (status==AVL_NOT_FOUND) ? AVL_OUT_OF_RANGE : status;
+
+}
+
+int avl_forest_min_get(
+  struct avl_forest *forest,
+  float             *min_value){
+
+    // The first non-empty shard holds the minimum.
+    for (int index = 0; index < forest->shard_count; index++){
+      struct avl_shard *shard=&forest->shards[index];
+      lock_guard<mutex> guard(shard->lock);
+      struct avl_node *min_node;
+      if (avl_min_get(shard->root,&min_node)==AVL_SUCCESS){
+        *min_value=min_node->value;
+        return AVL_SUCCESS;
+      }
+    }
+    return AVL_OUT_OF_RANGE;
+
+}
+
+int avl_forest_max_get(
+  struct avl_forest *forest,
+  float             *max_value){
+
+    // The last non-empty shard holds the maximum.
+    for (int index = forest->shard_count-1; index >= 0; index--){
+      struct avl_shard *shard=&forest->shards[index];
+      lock_guard<mutex> guard(shard->lock);
+      struct avl_node *max_node;
+      if (avl_max_get(shard->root,&max_node)==AVL_SUCCESS){
+        *max_value=max_node->value;
+        return AVL_SUCCESS;
+      }
+    }
+    return AVL_OUT_OF_RANGE;
+
+}
+
+int avl_forest_range_scan(
+  struct avl_forest *forest,
+  float              low,
+  float              high,
+  avl_visitor        visit,
+  void              *context){
+
+    // Also rejects NaN bounds, which belong to no shard interval.
+    if (visit==nullptr || !(low<=high)){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Shards are visited in key order, each one under its own lock. The
+    // scan resumes from the upper bound of the last shard, so a rebalance in
+    // between can't repeat or skip values.
+    float next_low=low;
+    while (true){
+      struct avl_shard *shard=lock_owner(forest,next_low);
+      int index=static_cast<int>(shard-forest->shards);
+      bool last_shard=(index+1==forest->shard_count);
+      float shard_high=last_shard ? high :
+                       min(high,forest->shards[index+1].low.load());
+      int status=avl_range_scan(shard->root,next_low,shard_high,visit,context);
+      shard->lock.unlock();
+
+      if (status!=AVL_SUCCESS || shard_high>=high){
+        return status;
+      }
+      next_low=shard_high;
+    }
+
+}
+
+int avl_forest_rebalance(
+  struct avl_forest *forest){
+    lock_all(forest);
+    int status=rebuild_shards(forest);
+    unlock_all(forest);
+    return status;
+}
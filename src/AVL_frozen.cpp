@@ -0,0 +1,208 @@
+#include "AVL_frozen.hpp"
+#include <cstdlib>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AVL_FROZEN_AVX2 1
+#endif
+
+
+using namespace std;
+
+
+
+// Walks the implicit tree in order while the visitor hands out the values
+// in order, so the array is filled without a sorted copy.
+struct freeze_state {
+  float    *keys;
+  uint32_t  count;
+  uint32_t  index;
+};
+
+// Leftmost implicit index below k.
+static uint32_t leftmost_index(
+  uint32_t k,
+  uint32_t count){
+    while (2*static_cast<uint64_t>(k)<=count){
+      k=2*k;
+    }
+    return k;
+}
+
+static int freeze_visit(
+  struct avl_node *node,
+  void            *context){
+    struct freeze_state *state=static_cast<struct freeze_state *>(context);
+    uint32_t k=state->index;
+    state->keys[k]=node->value;
+
+    // In-order successor: leftmost of the right child, or the first
+    // ancestor reached from a left child.
+    if (2*static_cast<uint64_t>(k)+1<=state->count){
+      state->index=leftmost_index(2*k+1,state->count);
+    }
+    else {
+      while (k & 1){
+        k>>=1;
+      }
+      state->index=k>>1;
+    }
+    return AVL_SUCCESS;
+}
+
+// Branchless descent: go right while the key is smaller than num, then
+// undo the right turns taken after the last left turn. Four levels ahead
+// the 16 descendants share one cache line, which is prefetched.
+static inline uint32_t lower_bound_index(
+  const float *keys,
+  uint32_t     count,
+  float        num){
+    uint64_t k=1;
+    while (k<=count){
+      __builtin_prefetch(keys+16*k);
+      k=2*k+(keys[k]<num);
+    }
+    k>>=__builtin_ffsll(~k);
+    return static_cast<uint32_t>(k);
+}
+
+#ifdef AVL_FROZEN_AVX2
+// Eight descents at once: gather the eight current keys, compare them with
+// the eight numbers in one instruction and step every lane. Lanes that
+// already left the tree keep their index.
+__attribute__((target("avx2")))
+static int lower_bound_avx2(
+  const float *keys,
+  uint32_t     count,
+  const float *nums,
+  int          size,
+  uint32_t    *indices){
+
+    int levels=0;
+    for (uint32_t rest = count; rest > 0; rest>>=1){
+      levels++;
+    }
+
+    const __m256i limit=_mm256_set1_epi32(static_cast<int>(count)+1);
+    const __m256i one=_mm256_set1_epi32(1);
+    int index=0;
+    for (; index+8 <= size; index+=8){
+      __m256 num=_mm256_loadu_ps(nums+index);
+      __m256i k=one;
+      for (int level = 0; level < levels; level++){
+        __m256i active=_mm256_cmpgt_epi32(limit,k);
+        __m256 key=_mm256_mask_i32gather_ps(_mm256_setzero_ps(),keys,k,
+                                            _mm256_castsi256_ps(active),4);
+        __m256i right=_mm256_srli_epi32(
+          _mm256_castps_si256(_mm256_cmp_ps(key,num,_CMP_LT_OQ)),31);
+        __m256i next=_mm256_add_epi32(_mm256_add_epi32(k,k),right);
+        k=_mm256_blendv_epi8(k,next,active);
+      }
+
+      uint32_t lanes[8];
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes),k);
+      for (int lane = 0; lane < 8; lane++){
+        uint64_t value=lanes[lane];
+        indices[index+lane]=static_cast<uint32_t>(value>>__builtin_ffsll(~value));
+      }
+    }
+    return index;
+}
+#endif
+
+int avl_freeze(
+  struct avl_node        *in_root,
+  struct avl_frozen_tree *frozen){
+
+    int size=get_size(in_root);
+    if (size>AVL_FROZEN_MAX_KEYS){
+      return AVL_OUT_OF_RANGE;
+    }
+    uint32_t count=static_cast<uint32_t>(size);
+
+    // Aligned so that every group of 16 descendants is one cache line.
+    void *memory=nullptr;
+    if (posix_memalign(&memory,64,(static_cast<size_t>(count)+1)*sizeof(float))!=0){
+      return AVL_OUT_OF_RANGE;
+    }
+    frozen->keys=static_cast<float *>(memory);
+    frozen->count=count;
+    frozen->keys[0]=0;
+
+    struct freeze_state state;
+    state.keys=frozen->keys;
+    state.count=count;
+    state.index=leftmost_index(1,count);
+    return avl_traverse(in_root,AVL_IN_ORDER,freeze_visit,&state);
+
+}
+
+void avl_frozen_free(
+  struct avl_frozen_tree *frozen){
+    free(frozen->keys);
+    frozen->keys=nullptr;
+    frozen->count=0;
+}
+
+int avl_frozen_search(
+  float                         num,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *found_index){
+
+    //if empty then avl is empty or doesnt exist.
+    if (frozen->count==0){
+      return AVL_NOT_FOUND;
+    }
+
+    // Only the lower bound can hold num.
+    uint32_t index=lower_bound_index(frozen->keys,frozen->count,num);
+    if (index==0 || frozen->keys[index]!=num){
+      return AVL_OUT_OF_RANGE;
+    }
+    *found_index=index;
+    return AVL_SUCCESS;
+
+}
+
+int avl_frozen_lower_bound(
+  float                         num,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *found_index){
+
+    //if empty then avl is empty or doesnt exist.
+    if (frozen->count==0){
+      return AVL_NOT_FOUND;
+    }
+
+    // No value satisfies the bound.
+    uint32_t index=lower_bound_index(frozen->keys,frozen->count,num);
+    if (index==0){
+      return AVL_OUT_OF_RANGE;
+    }
+    *found_index=index;
+    return AVL_SUCCESS;
+
+}
+
+int avl_frozen_lower_bound_batch(
+  const float                  *nums,
+  int                           count,
+  const struct avl_frozen_tree *frozen,
+  uint32_t                     *indices){
+
+    if (count<0 || (count>0 && (nums==nullptr || indices==nullptr))){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Full groups of eight go through AVX2 when the CPU has it.
+    int index=0;
+#ifdef AVL_FROZEN_AVX2
+    if (frozen->count>0 && __builtin_cpu_supports("avx2")){
+      index=lower_bound_avx2(frozen->keys,frozen->count,nums,count,indices);
+    }
+#endif
+    for (; index < count; index++){
+      indices[index]=lower_bound_index(frozen->keys,frozen->count,nums[index]);
+    }
+    return AVL_SUCCESS;
+
+}
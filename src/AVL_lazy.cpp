@@ -0,0 +1,256 @@
+#include "AVL_lazy.hpp"
+#include "AVL_generic.hpp"
+#include <vector>
+
+
+using namespace std;
+
+
+
+// Key accessor and counting order, as in AVL_tree.cpp.
+struct lazy_key {
+  float operator()(
+    const struct avl_node *node) const{
+      return node->value;
+  }
+};
+
+struct lazy_less {
+  bool operator()(
+    float first,
+    float second) const{
+      AVL_STATS_COMPARE();
+      return first<second;
+  }
+};
+
+// Sets the count of node and fixes the totals of its ancestors.
+static void set_count(
+  struct avl_node *node,
+  int              count){
+    int delta=count-node->count;
+    node->count=count;
+    for (; node!=nullptr; node=node->parent){
+      node->total+=delta;
+    }
+}
+
+// Tombstones passed the ratio of the nodes.
+static bool compact_due(
+  struct avl_lazy_tree *tree){
+    return tree->root != nullptr && tree->tombstones > tree->max_ratio*tree->root->size;
+}
+
+int avl_lazy_init(
+  struct avl_lazy_tree *tree,
+  float                 max_ratio){
+
+    if (tree==nullptr || !(max_ratio>0 && max_ratio<=1)){
+      return AVL_INVALID_PARAM;
+    }
+
+    tree->root=nullptr;
+    tree->tombstones=0;
+    tree->max_ratio=max_ratio;
+    return avl_pool_init(&(tree->pool),AVL_POOL_SLAB_SIZE);
+
+}
+
+void avl_lazy_free(
+  struct avl_lazy_tree *tree){
+
+    // Every node lives in the pool.
+    avl_pool_release(&(tree->pool));
+    tree->root=nullptr;
+    tree->tombstones=0;
+
+}
+
+int avl_lazy_add(
+  float                 num,
+  struct avl_lazy_tree *tree){
+
+    struct avl_node *found_node;
+    bool created=false;
+    AVL_STATS_SCOPE(AVL_STATS_INSERT);
+    AVL_TRACE_SPAN("avl_lazy_add");
+
+    // Rebuild once enough removes have paid for it.
+    if (compact_due(tree)){
+      avl_lazy_compact(tree);
+    }
+
+    // A removed value gets its node back.
+    int status=avl_detail::insert(&(tree->root),num,lazy_less(),lazy_key(),
+      [tree,num,&created](struct avl_node **link) -> int {
+        created=true;
+        return avl_pool_new_node(&(tree->pool),link,num);
+      },&found_node);
+    if (status!=AVL_SUCCESS){
+      return status;
+    }
+    if (!created && found_node->count==0){
+      set_count(found_node,1);
+      tree->tombstones--;
+    }
+    return AVL_SUCCESS;
+
+}
+
+int avl_lazy_remove(
+  float                 num,
+  struct avl_lazy_tree *tree){
+
+    //if nullptr then avl is empty or doesnt exist.
+    if (tree->root == nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+    AVL_TRACE_SPAN("avl_lazy_remove");
+
+    // Only the counts on the path change, no node moves.
+    struct avl_node *node=avl_detail::find(tree->root,num,lazy_less(),lazy_key());
+    if (node == nullptr || node->count == 0){
+      return AVL_OUT_OF_RANGE;
+    }
+    set_count(node,0);
+    tree->tombstones++;
+    return AVL_SUCCESS;
+
+}
+
+int avl_lazy_search(
+  float                  num,
+  struct avl_lazy_tree  *tree,
+  struct avl_node      **found_node){
+
+    //if nullptr then avl is empty or doesnt exist.
+    if (tree->root == nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    AVL_STATS_SCOPE(AVL_STATS_SEARCH);
+    AVL_TRACE_SPAN("avl_lazy_search");
+    struct avl_node *node=avl_detail::find(tree->root,num,lazy_less(),lazy_key());
+    if (node == nullptr || node->count == 0){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    *found_node=node;
+    return AVL_SUCCESS;
+
+}
+
+int avl_lazy_min_get(
+  struct avl_lazy_tree *tree,
+  float                *min_value){
+
+    // No live value, same as an empty avl_min_get/avl_max_get.
+    if (tree->root == nullptr || tree->root->total == 0){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    // Go left while the left subtree holds a live node.
+    struct avl_node *node=tree->root;
+    while (true){
+      if (node->lc_node != nullptr && node->lc_node->total > 0){
+        node=node->lc_node;
+      }
+      else if (node->count > 0){
+        *min_value=node->value;
+        return AVL_SUCCESS;
+      }
+      else {
+        node=node->rc_node;
+      }
+    }
+
+}
+
+int avl_lazy_max_get(
+  struct avl_lazy_tree *tree,
+  float                *max_value){
+
+    // No live value, same as an empty avl_min_get/avl_max_get.
+    if (tree->root == nullptr || tree->root->total == 0){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    // Go right while the right subtree holds a live node.
+    struct avl_node *node=tree->root;
+    while (true){
+      if (node->rc_node != nullptr && node->rc_node->total > 0){
+        node=node->rc_node;
+      }
+      else if (node->count > 0){
+        *max_value=node->value;
+        return AVL_SUCCESS;
+      }
+      else {
+        node=node->lc_node;
+      }
+    }
+
+}
+
+int avl_lazy_size(
+  struct avl_lazy_tree *tree){
+    return avl_multi_size(tree->root);
+}
+
+int avl_lazy_range_scan(
+  struct avl_lazy_tree *tree,
+  float                 low,
+  float                 high,
+  avl_visitor           visit,
+  void                 *context){
+
+    if (visit == nullptr || high < low){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Subtrees without live nodes are still walked; the ratio bounds them.
+    return avl_detail::range_scan(tree->root,low,high,less<float>(),lazy_key(),
+      [visit,context](struct avl_node *node) -> int {
+        return (node->count == 0) ? AVL_SUCCESS : visit(node,context);
+      });
+
+}
+
+int avl_lazy_compact(
+  struct avl_lazy_tree *tree){
+
+    AVL_TRACE_SPAN("avl_lazy_compact");
+
+    // Gather live nodes in order and free the rest.
+    vector<struct avl_node *> live;
+    live.reserve(avl_lazy_size(tree));
+    vector<struct avl_node *> stack;
+    struct avl_node *node=tree->root;
+    while (node != nullptr || !stack.empty()){
+      while (node != nullptr){
+        stack.push_back(node);
+        node=node->lc_node;
+      }
+      node=stack.back();
+      stack.pop_back();
+      struct avl_node *right=node->rc_node;
+      if (node->count == 0){
+        avl_pool_free_node(&(tree->pool),node);
+      }
+      else {
+        live.push_back(node);
+      }
+      node=right;
+    }
+
+    // Relink the same nodes into a perfectly balanced tree.
+    auto make=[&live](int index) -> struct avl_node * {
+      return live[index];
+    };
+    tree->root=avl_detail::build<struct avl_node>(0,static_cast<int>(live.size()),make);
+    tree->tombstones=0;
+    return AVL_SUCCESS;
+
+}
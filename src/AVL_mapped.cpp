@@ -0,0 +1,282 @@
+#include "AVL_mapped.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace std;
+
+
+
+// Stores the subtree of node in nodes[first, first+size) in increasing
+// order. Returns the index given to node.
+static uint32_t layout(
+  struct avl_node                 *node,
+  uint32_t                         first,
+  vector<struct avl_compact_node> &nodes){
+
+    uint32_t index=first+get_size(node->lc_node);
+    uint32_t left=AVL_COMPACT_NIL;
+    uint32_t right=AVL_COMPACT_NIL;
+    if (node->lc_node!=nullptr){
+      left=layout(node->lc_node,first,nodes);
+    }
+    if (node->rc_node!=nullptr){
+      right=layout(node->rc_node,index+1,nodes);
+    }
+
+    // Same balance bits as the compact tree.
+    int balance=get_height(node->lc_node)-get_height(node->rc_node);
+    uint32_t bits=(balance>0) ? 1u : ((balance<0) ? 2u : 0u);
+    nodes[index].value=node->value;
+    nodes[index].lc_index=left;
+    nodes[index].rc_bal=right | (bits << AVL_COMPACT_BALANCE_SHIFT);
+    return index;
+}
+
+int avl_mapped_write(
+  struct avl_node *in_root,
+  const char      *path){
+
+    uint32_t count=static_cast<uint32_t>(get_size(in_root));
+    if (path==nullptr || count>=AVL_COMPACT_NIL){
+      return AVL_INVALID_PARAM;
+    }
+
+    struct avl_mapped_header header;
+    memset(&header,0,sizeof(header));
+    strncpy(header.magic,AVL_MAPPED_MAGIC,sizeof(header.magic));
+    header.version=AVL_MAPPED_VERSION;
+    header.node_size=sizeof(struct avl_compact_node);
+    header.count=count;
+    header.root=AVL_COMPACT_NIL;
+
+    vector<struct avl_compact_node> nodes(count);
+    if (in_root!=nullptr){
+      header.root=layout(in_root,0,nodes);
+    }
+
+    FILE *file=fopen(path,"wb");
+    if (file==nullptr){
+      return AVL_NOT_FOUND;
+    }
+    bool written=fwrite(&header,sizeof(header),1,file)==1 &&
+                 fwrite(nodes.data(),sizeof(struct avl_compact_node),count,file)==count;
+    if (fclose(file)!=0 || !written){
+      return AVL_OUT_OF_RANGE;
+    }
+    return AVL_SUCCESS;
+
+}
+
+// Checks that every child index stays inside the file and matches the
+// increasing order of the array: the subtree of a node covers exactly
+// [first, last) and the node sits between its two halves. Every node is
+// then reached once, so no index is out of bounds and no cycle exists.
+static bool valid_nodes(
+  const struct avl_compact_node *nodes,
+  uint32_t                       count,
+  uint32_t                       root){
+
+    struct interval {
+      uint32_t index;
+      uint32_t first;
+      uint32_t last;
+    };
+    vector<struct interval> pending;
+    if (root!=AVL_COMPACT_NIL){
+      pending.push_back({root,0,count});
+    }
+    while (!pending.empty()){
+      struct interval current=pending.back();
+      pending.pop_back();
+      if (current.index<current.first || current.index>=current.last){
+        return false;
+      }
+      const struct avl_compact_node &node=nodes[current.index];
+      uint32_t left=avl_compact_lc(node);
+      uint32_t right=avl_compact_rc(node);
+      if ((left==AVL_COMPACT_NIL)!=(current.index==current.first) ||
+          (right==AVL_COMPACT_NIL)!=(current.index+1==current.last) ||
+          (node.rc_bal >> AVL_COMPACT_BALANCE_SHIFT)==3){
+        return false;
+      }
+      if (left!=AVL_COMPACT_NIL){
+        pending.push_back({left,current.first,current.index});
+      }
+      if (right!=AVL_COMPACT_NIL){
+        pending.push_back({right,current.index+1,current.last});
+      }
+    }
+
+    // Values strictly increase along the array (this also rejects NaN).
+    for (uint32_t index = 1; index < count; index++){
+      if (!(nodes[index-1].value<nodes[index].value)){
+        return false;
+      }
+    }
+    return true;
+}
+
+int avl_mapped_open(
+  const char             *path,
+  struct avl_mapped_tree *tree){
+
+    int fd=open(path,O_RDONLY);
+    if (fd<0){
+      return AVL_NOT_FOUND;
+    }
+    struct stat info;
+    if (fstat(fd,&info)!=0 ||
+        static_cast<size_t>(info.st_size)<sizeof(struct avl_mapped_header)){
+      close(fd);
+      return AVL_INVALID_PARAM;
+    }
+
+    // The mapping stays valid after closing the descriptor.
+    size_t length=static_cast<size_t>(info.st_size);
+    void *mapping=mmap(nullptr,length,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if (mapping==MAP_FAILED){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Reject other formats, versions and truncated files.
+    const struct avl_mapped_header *header=
+      static_cast<const struct avl_mapped_header *>(mapping);
+    bool valid=memcmp(header->magic,AVL_MAPPED_MAGIC,sizeof(AVL_MAPPED_MAGIC))==0 &&
+               header->version==AVL_MAPPED_VERSION &&
+               header->node_size==sizeof(struct avl_compact_node) &&
+               length==sizeof(struct avl_mapped_header)+
+                      static_cast<size_t>(header->count)*sizeof(struct avl_compact_node) &&
+               (header->count==0 ? header->root==AVL_COMPACT_NIL :
+                                   header->root<header->count);
+    if (!valid){
+      munmap(mapping,length);
+      return AVL_INVALID_PARAM;
+    }
+
+    // Nodes are not read here, so opening stays O(1) and touches only the
+    // first page. Queries check the indices they follow.
+    tree->mapping=mapping;
+    tree->length=length;
+    tree->nodes=reinterpret_cast<const struct avl_compact_node *>(header+1);
+    tree->count=header->count;
+    tree->root=header->root;
+    return AVL_SUCCESS;
+
+}
+
+int avl_mapped_verify(
+  const struct avl_mapped_tree *tree){
+    return valid_nodes(tree->nodes,tree->count,tree->root) ? AVL_SUCCESS :
+                                                             AVL_INVALID_PARAM;
+}
+
+void avl_mapped_close(
+  struct avl_mapped_tree *tree){
+    if (tree->mapping!=nullptr){
+      munmap(tree->mapping,tree->length);
+    }
+    tree->mapping=nullptr;
+    tree->nodes=nullptr;
+    tree->count=0;
+    tree->root=AVL_COMPACT_NIL;
+}
+
+int avl_mapped_search(
+  float                         num,
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *found_index){
+
+  //if empty then avl is empty or doesnt exist.
+  if (tree->root==AVL_COMPACT_NIL){
+    return AVL_NOT_FOUND;
+  }
+
+  // Descend until the value is found or a leaf is passed. A damaged file
+  // can't lead out of the array or around a cycle: every index is checked
+  // and no AVL tree is deeper than AVL_MAX_HEIGHT.
+  uint32_t current=tree->root;
+  for (int depth = 0; current!=AVL_COMPACT_NIL; depth++){
+    if (current>=tree->count || depth==AVL_MAX_HEIGHT){
+      return AVL_INVALID_PARAM;
+    }
+    const struct avl_compact_node &node=tree->nodes[current];
+    if (num < node.value){
+      current=avl_compact_lc(node);
+    }
+    else if (num > node.value){
+      current=avl_compact_rc(node);
+    }
+    else {
+      *found_index=current;
+      return AVL_SUCCESS;
+    }
+  }
+  return AVL_OUT_OF_RANGE;
+
+}
+
+int avl_mapped_min_get(
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *min_index){
+
+  if (tree->count==0){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  // Nodes are stored in increasing order.
+  *min_index=0;
+  return AVL_SUCCESS;
+
+}
+
+int avl_mapped_max_get(
+  const struct avl_mapped_tree *tree,
+  uint32_t                     *max_index){
+
+  if (tree->count==0){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  *max_index=tree->count-1;
+  return AVL_SUCCESS;
+
+}
+
+int avl_mapped_next(
+  const struct avl_mapped_tree *tree,
+  uint32_t                      index,
+  uint32_t                     *next_index){
+
+  if (index>=tree->count){
+    return AVL_INVALID_PARAM;
+  }
+  if (index+1==tree->count){
+    return AVL_OUT_OF_RANGE;
+  }
+  *next_index=index+1;
+  return AVL_SUCCESS;
+
+}
+
+int avl_mapped_prev(
+  const struct avl_mapped_tree *tree,
+  uint32_t                      index,
+  uint32_t                     *prev_index){
+
+  if (index>=tree->count){
+    return AVL_INVALID_PARAM;
+  }
+  if (index==0){
+    return AVL_OUT_OF_RANGE;
+  }
+  *prev_index=index-1;
+  return AVL_SUCCESS;
+
+}
@@ -0,0 +1,285 @@
+#include "AVL_persistent.hpp"
+#include <algorithm>
+
+
+using namespace std;
+
+
+
+// Height of a possibly empty subtree.
+static int pnode_height(
+  const struct avl_pnode *node){
+    return (node==nullptr) ? 0 : node->height;
+}
+
+// Size of a possibly empty subtree.
+static int pnode_size(
+  const struct avl_pnode *node){
+    return (node==nullptr) ? 0 : node->size;
+}
+
+// Adds a reference to a shared node and returns it.
+static struct avl_pnode *retain(
+  struct avl_pnode *node){
+    if (node!=nullptr){
+      node->refs.fetch_add(1,memory_order_relaxed);
+    }
+    return node;
+}
+
+// Drops a reference and frees the node, and recursively its children, when
+// no version points to it anymore.
+static void release(
+  struct avl_pnode *node){
+    while (node!=nullptr &&
+           node->refs.fetch_sub(1,memory_order_acq_rel)==1){
+      struct avl_pnode *right=node->rc_node;
+      release(node->lc_node);
+      delete node;
+      node=right;
+    }
+}
+
+// Creates a node that takes over the references to both children.
+static struct avl_pnode *make(
+  float             value,
+  struct avl_pnode *left,
+  struct avl_pnode *right){
+    struct avl_pnode *node=new struct avl_pnode;
+    node->lc_node=left;
+    node->rc_node=right;
+    node->value=value;
+    node->height=max(pnode_height(left),pnode_height(right))+1;
+    node->size=pnode_size(left)+pnode_size(right)+1;
+    node->refs.store(1,memory_order_relaxed);
+    return node;
+}
+
+// Creates a node over two owned subtrees whose heights differ by at most
+// two, rotating by building new nodes instead of modifying shared ones.
+static struct avl_pnode *balance(
+  float             value,
+  struct avl_pnode *left,
+  struct avl_pnode *right){
+
+    int left_height=pnode_height(left);
+    int right_height=pnode_height(right);
+
+    if (left_height>right_height+1){
+      struct avl_pnode *root;
+      if (pnode_height(left->lc_node)>=pnode_height(left->rc_node)){
+        // Left-Left case: single right rotation.
+        root=make(left->value,retain(left->lc_node),
+                  make(value,retain(left->rc_node),right));
+      }
+      else {
+        // Left-Right case: the inner grandchild becomes the root.
+        struct avl_pnode *inner=left->rc_node;
+        root=make(inner->value,
+                  make(left->value,retain(left->lc_node),retain(inner->lc_node)),
+                  make(value,retain(inner->rc_node),right));
+      }
+      release(left);
+      return root;
+    }
+
+    if (right_height>left_height+1){
+      struct avl_pnode *root;
+      if (pnode_height(right->rc_node)>=pnode_height(right->lc_node)){
+        // Right-Right case: single left rotation.
+        root=make(right->value,make(value,left,retain(right->lc_node)),
+                  retain(right->rc_node));
+      }
+      else {
+        // Right-Left case: the inner grandchild becomes the root.
+        struct avl_pnode *inner=right->lc_node;
+        root=make(inner->value,
+                  make(value,left,retain(inner->lc_node)),
+                  make(right->value,retain(inner->rc_node),retain(right->rc_node)));
+      }
+      release(right);
+      return root;
+    }
+
+    return make(value,left,right);
+}
+
+// Returns an owned copy of the subtree with num inserted. Only the nodes on
+// the path are new, the rest are shared with the previous version.
+static struct avl_pnode *insert(
+  struct avl_pnode *node,
+  float             num){
+
+    if (node==nullptr){
+      return make(num,nullptr,nullptr);
+    }
+    if (num<node->value){
+      return balance(node->value,insert(node->lc_node,num),retain(node->rc_node));
+    }
+    return balance(node->value,retain(node->lc_node),insert(node->rc_node,num));
+}
+
+// Returns an owned copy of the subtree without num, which must be present.
+static struct avl_pnode *erase(
+  struct avl_pnode *node,
+  float             num){
+
+    if (num<node->value){
+      return balance(node->value,erase(node->lc_node,num),retain(node->rc_node));
+    }
+    if (num>node->value){
+      return balance(node->value,retain(node->lc_node),erase(node->rc_node,num));
+    }
+
+    // One child at most, it replaces the node.
+    if (node->lc_node==nullptr){
+      return retain(node->rc_node);
+    }
+    if (node->rc_node==nullptr){
+      return retain(node->lc_node);
+    }
+
+    // Two children, the successor takes the place of the node.
+    const struct avl_pnode *successor=node->rc_node;
+    while (successor->lc_node!=nullptr){
+      successor=successor->lc_node;
+    }
+    float value=successor->value;
+    return balance(value,retain(node->lc_node),erase(node->rc_node,value));
+}
+
+// Finds num below node, or returns nullptr.
+static const struct avl_pnode *find(
+  const struct avl_pnode *node,
+  float                   num){
+    while (node!=nullptr && num!=node->value){
+      node=(num<node->value) ? node->lc_node : node->rc_node;
+    }
+    return node;
+}
+
+// Publishes new_root as the current version and drops the previous one.
+static void publish(
+  struct avl_persistent_tree *tree,
+  struct avl_pnode           *new_root){
+    struct avl_pnode *old_root;
+    {
+      lock_guard<mutex> guard(tree->root_lock);
+      old_root=tree->root;
+      tree->root=new_root;
+    }
+    release(old_root);
+}
+
+void avl_persistent_init(
+  struct avl_persistent_tree *tree){
+    tree->root=nullptr;
+}
+
+void avl_persistent_free(
+  struct avl_persistent_tree *tree){
+    publish(tree,nullptr);
+}
+
+int avl_persistent_add(
+  float                       num,
+  struct avl_persistent_tree *tree){
+
+    // Repeated values leave the current version untouched.
+    if (find(tree->root,num)!=nullptr){
+      return AVL_SUCCESS;
+    }
+
+    publish(tree,insert(tree->root,num));
+    return AVL_SUCCESS;
+
+}
+
+int avl_persistent_remove(
+  float                       num,
+  struct avl_persistent_tree *tree){
+
+    // Identify if the tree is empty.
+    if (tree->root==nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    // Missing values leave the current version untouched.
+    if (find(tree->root,num)==nullptr){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    publish(tree,erase(tree->root,num));
+    return AVL_SUCCESS;
+
+}
+
+void avl_persistent_snapshot(
+  struct avl_persistent_tree *tree,
+  struct avl_snapshot        *snapshot){
+    // The root can't be released between reading and retaining it.
+    lock_guard<mutex> guard(tree->root_lock);
+    snapshot->root=retain(tree->root);
+}
+
+void avl_snapshot_release(
+  struct avl_snapshot *snapshot){
+    release(snapshot->root);
+    snapshot->root=nullptr;
+}
+
+int avl_snapshot_search(
+  float                       num,
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **found_node){
+
+    // Identify if the version is empty.
+    if (snapshot->root==nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    *found_node=find(snapshot->root,num);
+    return (*found_node!=nullptr) ? AVL_SUCCESS : AVL_OUT_OF_RANGE;
+
+}
+
+int avl_snapshot_min_get(
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **min_node){
+
+    // Identify if the version is empty.
+    if (snapshot->root==nullptr){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    const struct avl_pnode *node=snapshot->root;
+    while (node->lc_node!=nullptr){
+      node=node->lc_node;
+    }
+    *min_node=node;
+    return AVL_SUCCESS;
+
+}
+
+int avl_snapshot_max_get(
+  const struct avl_snapshot  *snapshot,
+  const struct avl_pnode    **max_node){
+
+    // Identify if the version is empty.
+    if (snapshot->root==nullptr){
+      return AVL_OUT_OF_RANGE;
+    }
+
+    const struct avl_pnode *node=snapshot->root;
+    while (node->rc_node!=nullptr){
+      node=node->rc_node;
+    }
+    *max_node=node;
+    return AVL_SUCCESS;
+
+}
+
+int avl_snapshot_size(
+  const struct avl_snapshot *snapshot){
+    return pnode_size(snapshot->root);
+}
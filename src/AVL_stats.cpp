@@ -0,0 +1,80 @@
+#include "AVL_stats.hpp"
+
+
+using namespace std;
+
+
+#ifdef AVL_STATS
+namespace avl_detail {
+thread_local struct avl_stats *stats_target=nullptr;
+thread_local int stats_operation=-1;
+} /* namespace avl_detail */
+#endif
+
+void avl_stats_reset(
+  struct avl_stats *stats){
+
+    for (int operation = 0; operation < AVL_STATS_OPERATIONS; operation++){
+      stats->operations[operation].store(0,memory_order_relaxed);
+      stats->comparisons[operation].store(0,memory_order_relaxed);
+      stats->single_rotations[operation].store(0,memory_order_relaxed);
+      stats->double_rotations[operation].store(0,memory_order_relaxed);
+      for (int depth = 0; depth < AVL_STATS_DEPTHS; depth++){
+        stats->depths[operation][depth].store(0,memory_order_relaxed);
+      }
+    }
+    stats->allocations.store(0,memory_order_relaxed);
+    stats->frees.store(0,memory_order_relaxed);
+    stats->live_bytes.store(0,memory_order_relaxed);
+
+}
+
+struct avl_stats *avl_stats_bind(
+  struct avl_stats *stats){
+
+#ifdef AVL_STATS
+    struct avl_stats *previous=avl_detail::stats_target;
+    avl_detail::stats_target=stats;
+    return previous;
+#else
+    // Nothing is recorded, so nothing is ever bound.
+    (void)stats;
+    return nullptr;
+#endif
+
+}
+
+int avl_stats_snapshot(
+  const struct avl_stats    *stats,
+  struct avl_stats_counters *snapshot){
+
+#ifdef AVL_STATS
+    if (stats==nullptr || snapshot==nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Each counter is read on its own; counters of an operation in course
+    // may be one step apart.
+    for (int operation = 0; operation < AVL_STATS_OPERATIONS; operation++){
+      snapshot->operations[operation]=stats->operations[operation].load(memory_order_relaxed);
+      snapshot->comparisons[operation]=stats->comparisons[operation].load(memory_order_relaxed);
+      snapshot->single_rotations[operation]=
+        stats->single_rotations[operation].load(memory_order_relaxed);
+      snapshot->double_rotations[operation]=
+        stats->double_rotations[operation].load(memory_order_relaxed);
+      for (int depth = 0; depth < AVL_STATS_DEPTHS; depth++){
+        snapshot->depths[operation][depth]=
+          stats->depths[operation][depth].load(memory_order_relaxed);
+      }
+    }
+    snapshot->allocations=stats->allocations.load(memory_order_relaxed);
+    snapshot->frees=stats->frees.load(memory_order_relaxed);
+    snapshot->live_bytes=stats->live_bytes.load(memory_order_relaxed);
+    return AVL_SUCCESS;
+#else
+    (void)stats;
+    (void)snapshot;
+    return AVL_NOT_FOUND;
+#endif
+
+}
@@ -0,0 +1,158 @@
+#include "AVL_trace.hpp"
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+
+using namespace std;
+
+
+#ifdef AVL_TRACE
+namespace avl_detail {
+atomic<bool> trace_enabled(false);
+thread_local struct trace_buffer *trace_local=nullptr;
+} /* namespace avl_detail */
+
+// Buffers of every thread that recorded a span. They are never freed:
+// spans of finished threads can still be written, and then the buffer is
+// handed to the next new thread.
+static mutex trace_registry_lock;
+static vector<struct avl_detail::trace_buffer *> trace_registry;
+
+// Spans that started before the last avl_trace_start are not written.
+static atomic<uint64_t> trace_epoch(0);
+
+// Retires the buffer of the thread when the thread exits.
+struct trace_owner {
+  struct avl_detail::trace_buffer *buffer=nullptr;
+  ~trace_owner(){
+      if (buffer != nullptr){
+        avl_detail::trace_local=nullptr;
+        buffer->retired.store(true,memory_order_release);
+      }
+  }
+};
+static thread_local struct trace_owner trace_local_owner;
+
+// A retired buffer is free once no dump would write its spans again.
+static bool trace_reusable(
+  struct avl_detail::trace_buffer *buffer){
+    if (!buffer->retired.load(memory_order_acquire)){
+      return false;
+    }
+    uint64_t head=buffer->head.load(memory_order_relaxed);
+    if (head == 0 || buffer->dumped == head){
+      return true;
+    }
+    const struct avl_detail::trace_event &newest=
+      buffer->events[(head-1) & (AVL_TRACE_CAPACITY-1)];
+    return newest.start.load(memory_order_relaxed) < trace_epoch.load(memory_order_relaxed);
+}
+
+struct avl_detail::trace_buffer *avl_detail::trace_register(){
+    lock_guard<mutex> guard(trace_registry_lock);
+    struct trace_buffer *buffer=nullptr;
+    for (size_t index = 0; index < trace_registry.size() && buffer == nullptr; index++){
+      if (trace_reusable(trace_registry[index])){
+        buffer=trace_registry[index];
+      }
+    }
+    if (buffer == nullptr){
+      buffer=new struct trace_buffer;
+      trace_registry.push_back(buffer);
+    }
+
+    // Fresh track: a new thread id and no spans.
+    static int next_tid=0;
+    buffer->tid=++next_tid;
+    buffer->head.store(0,memory_order_relaxed);
+    buffer->dumped=0;
+    buffer->retired.store(false,memory_order_relaxed);
+    trace_local_owner.buffer=buffer;
+    trace_local=buffer;
+    return buffer;
+}
+#endif
+
+int avl_trace_start(){
+
+#ifdef AVL_TRACE
+    trace_epoch.store(avl_detail::trace_now(),memory_order_relaxed);
+    avl_detail::trace_enabled.store(true,memory_order_relaxed);
+    return AVL_SUCCESS;
+#else
+    return AVL_NOT_FOUND;
+#endif
+
+}
+
+void avl_trace_stop(){
+
+#ifdef AVL_TRACE
+    avl_detail::trace_enabled.store(false,memory_order_relaxed);
+#endif
+
+}
+
+int avl_trace_dump(
+  const char *path){
+
+#ifdef AVL_TRACE
+    FILE *file=fopen(path,"w");
+    if (file==nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    // Held while writing, so no buffer is handed to a new thread meanwhile.
+    lock_guard<mutex> guard(trace_registry_lock);
+    const vector<struct avl_detail::trace_buffer *> &buffers=trace_registry;
+
+    uint64_t epoch=trace_epoch.load(memory_order_relaxed);
+    bool first=true;
+    bool written=fprintf(file,"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[")>0;
+    for (size_t index = 0; index < buffers.size() && written; index++){
+      struct avl_detail::trace_buffer *buffer=buffers[index];
+
+      // Copy the newest spans, then drop the slots the owner overwrote
+      // meanwhile: while it writes span h it already published head h.
+      uint64_t head=buffer->head.load(memory_order_acquire);
+      uint64_t oldest=(head > AVL_TRACE_CAPACITY) ? head-AVL_TRACE_CAPACITY : 0;
+      vector<const char *> names;
+      vector<uint64_t> starts;
+      vector<uint64_t> durations;
+      for (uint64_t span = oldest; span < head; span++){
+        const struct avl_detail::trace_event &event=
+          buffer->events[span & (AVL_TRACE_CAPACITY-1)];
+        names.push_back(event.name.load(memory_order_relaxed));
+        starts.push_back(event.start.load(memory_order_relaxed));
+        durations.push_back(event.duration.load(memory_order_relaxed));
+      }
+      atomic_thread_fence(memory_order_acquire);
+      uint64_t current=buffer->head.load(memory_order_relaxed);
+      uint64_t valid=(current >= AVL_TRACE_CAPACITY) ? current-AVL_TRACE_CAPACITY+1 : 0;
+
+      buffer->dumped=head;
+      for (uint64_t span = max(oldest,valid); span < head && written; span++){
+        size_t slot=static_cast<size_t>(span-oldest);
+        if (starts[slot]<epoch){
+          continue;
+        }
+        // Chrome expects microseconds.
+        written=fprintf(file,"%s\n{\"name\":\"%s\",\"cat\":\"avl\",\"ph\":\"X\",\"pid\":1,"
+                             "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        first ? "" : ",",names[slot],buffer->tid,
+                        starts[slot]/1000.0,durations[slot]/1000.0)>0;
+        first=false;
+      }
+    }
+    written=written && fprintf(file,"\n]}\n")>0;
+    if (fclose(file)!=0 || !written){
+      return AVL_OUT_OF_RANGE;
+    }
+    return AVL_SUCCESS;
+#else
+    (void)path;
+    return AVL_NOT_FOUND;
+#endif
+
+}
@@ -1,5 +1,6 @@
 #include <bits/stdc++.h> 
 #include "AVL_tree.hpp"
+#include "AVL_generic.hpp"
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
@@ -8,6 +9,24 @@
 using namespace std;
 
 
+// Key accessor used to run the generic algorithms on float nodes.
+struct avl_float_key {
+  float operator()(
+    const struct avl_node *node) const{
+      return node->value;
+  }
+};
+
+// Key order for the float functions that keep operation counters.
+struct avl_float_less {
+  bool operator()(
+    float first,
+    float second) const{
+      AVL_STATS_COMPARE();
+      return first<second;
+  }
+};
+
 
 int max(
   int height_1,
@@ -32,44 +51,49 @@ int min3(
 }
 
 float median(float in_list[], int list_size){ 
-    // First we sort the array 
-    sort(in_list, in_list + list_size); 
+    // Place the upper middle element, smaller ones end up before it.
+    nth_element(in_list, in_list + list_size / 2, in_list + list_size); 
   
     // Check case
     if (list_size % 2 != 0){
       return in_list[list_size / 2]; 
     }
   
-    return (in_list[(list_size - 1) / 2] + in_list[list_size / 2]) / 2.0; 
+    // Lower middle element is the greatest of the first half.
+    float lower = *max_element(in_list, in_list + list_size / 2);
+    return (lower + in_list[list_size / 2]) / 2.0; 
 } 
 
 
 int get_height(
   struct avl_node *current_node){
 
-    // Ending condition, when the node is inexistent.
-    if (current_node==nullptr){
-        return 0;
-    }
+    // Height is kept up to date by insertions, removals and rotations.
+    return avl_detail::height(current_node);
+}
+
 
-    // Get left and right side heights.
-    int left_height=get_height(current_node->lc_node);
-    int right_height=get_height(current_node->rc_node);
+int get_size(
+  struct avl_node *current_node){
 
-    // Return max plus current node.
-    return max(left_height,right_height)+1;
+    // Size is kept up to date together with the height.
+    return avl_detail::size(current_node);
 }
 
 
-int get_balance(
+void update_height(
   struct avl_node *current_node){
 
-    // Get left and right side heights.
-    int left_height = get_height(current_node->lc_node);
-    int right_height = get_height(current_node->rc_node);
+    // Store max of the children plus current node.
+    avl_detail::update(current_node);
+}
+
+
+int get_balance(
+  struct avl_node *current_node){
 
     // Return height difference.
-    return left_height-right_height;
+    return avl_detail::balance(current_node);
 
 }
 
@@ -79,43 +103,152 @@ int new_node(
 
     // Assign pointing address.
     *node_ptr=new struct avl_node;
+    AVL_STATS_ALLOC(1,sizeof(struct avl_node));
 
     // Initially no children, use value given.
     (*node_ptr)->lc_node=nullptr;
     (*node_ptr)->rc_node=nullptr;
+    (*node_ptr)->parent=nullptr;
     (*node_ptr)->value = value;
+    (*node_ptr)->height = 1;
+    (*node_ptr)->size = 1;
+    (*node_ptr)->count = 1;
+    (*node_ptr)->total = 1;
 
     // Return success state.
     return AVL_SUCCESS;
 
 }
 
-int left_rotation(
-  struct avl_node **rot_top_node){
+int avl_pool_init(
+  struct avl_pool *pool,
+  int              slab_size){
 
-    // Left rotations require right children.
-    if ((*rot_top_node)->rc_node==nullptr){
-      return AVL_INVALID_ROT;
+    // Slabs must hold at least one node.
+    if (pool==nullptr || slab_size<1){
+      return AVL_INVALID_PARAM;
     }
 
-    // Get relevant items pointers.
-    struct avl_node *rc=(*rot_top_node)->rc_node;
-    struct avl_node *lc_of_rc=rc->lc_node;
+    // Start with no slabs and an empty free list.
+    pool->slabs=nullptr;
+    pool->free_list=nullptr;
+    pool->next_free=nullptr;
+    pool->remaining=0;
+    pool->slab_size=slab_size;
+    pool->live_nodes=0;
+
+    return AVL_SUCCESS;
+
+}
 
-    // Guard against nullptr reference.
-    if (rc==nullptr){
-      lc_of_rc=nullptr;
+int avl_pool_new_node(
+  struct avl_pool  *pool,
+  struct avl_node **node_ptr,
+  float             value){
+
+    // Reuse removed nodes first.
+    if (pool->free_list!=nullptr){
+      *node_ptr=pool->free_list;
+      pool->free_list=pool->free_list->lc_node;
     }
-    else{
-      lc_of_rc=rc->lc_node;
+    else {
+      // Carve a new slab when the current one is used up.
+      if (pool->remaining==0){
+        struct avl_slab *slab=new struct avl_slab;
+        slab->nodes=new struct avl_node[pool->slab_size];
+        slab->next=pool->slabs;
+        pool->slabs=slab;
+        pool->next_free=slab->nodes;
+        pool->remaining=pool->slab_size;
+      }
+      *node_ptr=pool->next_free;
+      pool->next_free++;
+      pool->remaining--;
     }
+    pool->live_nodes++;
+    AVL_STATS_ALLOC(1,sizeof(struct avl_node));
 
-    // Perform rotation.
-    rc->lc_node=(*rot_top_node);
-    (*rot_top_node)->rc_node=lc_of_rc;
+    // Initially no children, use value given.
+    (*node_ptr)->lc_node=nullptr;
+    (*node_ptr)->rc_node=nullptr;
+    (*node_ptr)->parent=nullptr;
+    (*node_ptr)->value = value;
+    (*node_ptr)->height = 1;
+    (*node_ptr)->size = 1;
+    (*node_ptr)->count = 1;
+    (*node_ptr)->total = 1;
 
-    // Update rot_top_node.
-    (*rot_top_node)=rc;
+    // Return success state.
+    return AVL_SUCCESS;
+
+}
+
+void avl_pool_free_node(
+  struct avl_pool *pool,
+  struct avl_node *node){
+
+    // Push the node on the free list, linked through its left child.
+    node->lc_node=pool->free_list;
+    pool->free_list=node;
+    pool->live_nodes--;
+    AVL_STATS_FREE(1,sizeof(struct avl_node));
+
+}
+
+void avl_pool_release(
+  struct avl_pool *pool){
+
+    // Drop whole slabs, nodes are never visited one by one.
+    AVL_TRACE_SPAN("avl_pool_release");
+    AVL_STATS_FREE(pool->live_nodes,
+                   static_cast<int64_t>(pool->live_nodes)*sizeof(struct avl_node));
+    while (pool->slabs!=nullptr){
+      struct avl_slab *slab=pool->slabs;
+      pool->slabs=slab->next;
+      delete[] slab->nodes;
+      delete slab;
+    }
+
+    // Leave the pool empty and ready to be used again.
+    avl_pool_init(pool,pool->slab_size);
+
+}
+
+// Allocates a node from the pool, or from the heap when no pool is given.
+static int pool_new_node(
+  struct avl_pool  *pool,
+  struct avl_node **node_ptr,
+  float             value){
+
+    if (pool==nullptr){
+      return new_node(node_ptr,value);
+    }
+    return avl_pool_new_node(pool,node_ptr,value);
+}
+
+// Gives a node back to its pool, or to the heap when no pool is given.
+static void pool_free_node(
+  struct avl_pool *pool,
+  struct avl_node *node){
+
+    if (pool==nullptr){
+      AVL_STATS_FREE(1,sizeof(struct avl_node));
+      delete node;
+      return;
+    }
+    avl_pool_free_node(pool,node);
+}
+
+int left_rotation(
+  struct avl_node **rot_top_node){
+
+    // Left rotations require right children.
+    if ((*rot_top_node)->rc_node==nullptr){
+      return AVL_INVALID_ROT;
+    }
+
+    // Perform rotation, heights are updated bottom up.
+    avl_detail::rotate_left(rot_top_node);
 
     // Return success.
     return AVL_SUCCESS;
@@ -130,24 +263,8 @@ int right_rotation(
       return AVL_INVALID_ROT;
     }
 
-    // Get relevant items pointers.
-    struct avl_node *lc=(*rot_top_node)->lc_node;
-    struct avl_node *rc_of_lc;
-
-    // Guard against nullptr reference.
-    if (lc==nullptr){
-      rc_of_lc=nullptr;
-    }
-    else{
-      rc_of_lc=lc->rc_node;
-    }
-
-    // Perform rotation.
-    lc->rc_node=(*rot_top_node);
-    (*rot_top_node)->lc_node=rc_of_lc;
-
-    // Update rot_top_node.
-    *rot_top_node=lc;
+    // Perform rotation, heights are updated bottom up.
+    avl_detail::rotate_right(rot_top_node);
 
     // Return success.
     return AVL_SUCCESS;
@@ -162,6 +279,7 @@ int avl_create(
 
     // Initialize status as success.
     int status=AVL_SUCCESS;
+    AVL_TRACE_SPAN("avl_create");
 
     // Identify invalid list sizes and return.
     if (list_size<1){
@@ -186,204 +304,767 @@ int avl_create(
 
 }
 
+// Builds the subtree for sorted_list[first, last) and returns its root.
+static struct avl_node *build_range(
+  const float     *sorted_list,
+  int              first,
+  int              last,
+  struct avl_pool *pool){
+
+    // Nodes are created in order of the list positions.
+    auto make=[sorted_list,pool](int index) -> struct avl_node * {
+      struct avl_node *node=nullptr;
+      pool_new_node(pool,&node,sorted_list[index]);
+      return node;
+    };
+    return avl_detail::build<struct avl_node>(first,last,make);
+}
+
+// Copies a list, sorting it only when needed and dropping repeated elements.
+static vector<float> sorted_unique_copy(
+  const float *in_number_list,
+  int          list_size){
+
+    vector<float> sorted(in_number_list,in_number_list+list_size);
+    if (!is_sorted(sorted.begin(),sorted.end())){
+      sort(sorted.begin(),sorted.end());
+    }
+    sorted.erase(unique(sorted.begin(),sorted.end()),sorted.end());
+    return sorted;
+}
+
+int avl_build_sorted(
+  const float      *sorted_list,
+  int               list_size,
+  struct avl_node **new_root_node){
+
+    // Nodes come from the global heap.
+    return avl_pool_build_sorted(sorted_list,list_size,new_root_node,nullptr);
+
+}
+
+int avl_pool_build_sorted(
+  const float      *sorted_list,
+  int               list_size,
+  struct avl_node **new_root_node,
+  struct avl_pool  *pool){
+
+    // Identify invalid list sizes and return.
+    if (list_size<1 || sorted_list==nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Only empty trees can be built from scratch.
+    if (*new_root_node!=nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    AVL_TRACE_SPAN("avl_build_sorted");
+    *new_root_node=build_range(sorted_list,0,list_size,pool);
+    return AVL_SUCCESS;
+
+}
+
+int avl_bulk_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node){
+
+    // Nodes come from the global heap.
+    return avl_pool_bulk_create(in_number_list,list_size,new_root_node,nullptr);
+
+}
+
+int avl_pool_bulk_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node,
+  struct avl_pool  *pool){
+
+    // Identify invalid list sizes and return.
+    if (list_size<1){
+      return AVL_INVALID_PARAM;
+    }
+    AVL_TRACE_SPAN("avl_bulk_create");
+
+    // Existing trees keep the incremental behaviour.
+    if (*new_root_node!=nullptr){
+      for (int index = 0; index < list_size; index++){
+        int status=avl_pool_node_add(in_number_list[index],new_root_node,pool);
+        if (status!=AVL_SUCCESS){
+          return status;
+        }
+      }
+      return AVL_SUCCESS;
+    }
+
+    // Work on a copy so the caller's list is left untouched.
+    vector<float> sorted=sorted_unique_copy(in_number_list,list_size);
+
+    return avl_pool_build_sorted(sorted.data(),static_cast<int>(sorted.size()),
+                                 new_root_node,pool);
+
+}
+
+// Sorts values with up to thread_count threads: chunks are sorted
+// concurrently and then merged pairwise, also concurrently.
+static void parallel_sort(
+  vector<float> &values,
+  int            thread_count){
+
+    size_t chunk_count=static_cast<size_t>(thread_count);
+    if (chunk_count<2 || values.size()<2*AVL_PARALLEL_GRAIN){
+      sort(values.begin(),values.end());
+      return;
+    }
+
+    // Chunk boundaries.
+    vector<size_t> bounds;
+    for (size_t index = 0; index <= chunk_count; index++){
+      bounds.push_back(values.size()*index/chunk_count);
+    }
+
+    // Sort each chunk in its own thread.
+    vector<thread> workers;
+    for (size_t index = 0; index < chunk_count; index++){
+      workers.push_back(thread([&values,&bounds,index](){
+        sort(values.begin()+bounds[index],values.begin()+bounds[index+1]);
+      }));
+    }
+    for (size_t index = 0; index < workers.size(); index++){
+      workers[index].join();
+    }
+
+    // Merge neighbour runs until one run is left, ping-ponging buffers.
+    vector<float> buffer(values.size());
+    while (bounds.size()>2){
+      vector<size_t> merged_bounds;
+      workers.clear();
+      for (size_t index = 0; index+1 < bounds.size(); index+=2){
+        size_t first=bounds[index];
+        size_t middle=bounds[index+1];
+        size_t last=(index+2 < bounds.size()) ? bounds[index+2] : middle;
+        merged_bounds.push_back(first);
+        workers.push_back(thread([&values,&buffer,first,middle,last](){
+          merge(values.begin()+first,values.begin()+middle,
+                values.begin()+middle,values.begin()+last,
+                buffer.begin()+first);
+        }));
+      }
+      merged_bounds.push_back(values.size());
+      for (size_t index = 0; index < workers.size(); index++){
+        workers[index].join();
+      }
+      values.swap(buffer);
+      bounds.swap(merged_bounds);
+    }
+}
+
+int avl_parallel_create(
+  float           *in_number_list,
+  int              list_size,
+  struct avl_node **new_root_node,
+  int              thread_count){
+
+    // Identify invalid parameters and return.
+    if (list_size<1 || thread_count<1 || in_number_list==nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Only empty trees can be built from scratch.
+    if (*new_root_node!=nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Sort a copy in parallel, then drop repeated elements.
+    AVL_TRACE_SPAN("avl_parallel_create");
+    vector<float> sorted(in_number_list,in_number_list+list_size);
+    parallel_sort(sorted,thread_count);
+    sorted.erase(unique(sorted.begin(),sorted.end()),sorted.end());
+
+    // Build disjoint subtrees concurrently on the heap.
+    auto make=[&sorted](int index) -> struct avl_node * {
+      struct avl_node *node=nullptr;
+      new_node(&node,sorted[index]);
+      return node;
+    };
+    *new_root_node=avl_detail::build_parallel<struct avl_node>(
+      0,static_cast<int>(sorted.size()),make,
+      avl_detail::spawn_depth(thread_count));
+    return AVL_SUCCESS;
+
+}
+
 int avl_node_add(
   float num,
   struct avl_node **new_root){
 
-    int status = AVL_SUCCESS;
-    int status_1 = AVL_SUCCESS;
-    int status_2 = AVL_SUCCESS;
+    // Nodes come from the global heap.
+    return avl_pool_node_add(num,new_root,nullptr);
+
+}
+
+int avl_pool_node_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    struct avl_node *found_node;
+    AVL_STATS_SCOPE(AVL_STATS_INSERT);
+    AVL_TRACE_SPAN("avl_node_add");
+
+    // Single descent with a path stack, the node is only created when the
+    // value is new. Repeated elements are ignored.
+    return avl_detail::insert(new_root,num,avl_float_less(),avl_float_key(),
+      [pool,num](struct avl_node **link) -> int {
+        return pool_new_node(pool,link,num);
+      },&found_node);
+
+}
+
+int avl_node_remove(
+  float num,
+  struct avl_node **new_root){
+
+    // Nodes go back to the global heap.
+    return avl_pool_node_remove(num,new_root,nullptr);
+
+}
+
+int avl_pool_node_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    struct avl_node *removed_node;
+    AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+    AVL_TRACE_SPAN("avl_node_remove");
+
+    // Unlink the node and rebalance, then give it back to its owner.
+    int status=avl_detail::unlink(new_root,num,avl_float_less(),avl_float_key(),
+                                  &removed_node);
+    if (status==AVL_SUCCESS){
+      pool_free_node(pool,removed_node);
+    }
+    return status;
+}
+
+int avl_hint_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint){
+
+    // Nodes come from the global heap.
+    return avl_pool_hint_add(num,new_root,hint,nullptr);
+
+}
+
+int avl_pool_hint_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint,
+  struct avl_pool  *pool){
+
+    AVL_STATS_SCOPE(AVL_STATS_INSERT);
+    AVL_TRACE_SPAN("avl_hint_add");
+
+    // Search from the finger, the inserted node is the next finger.
+    return avl_detail::insert_hint(new_root,*hint,num,avl_float_less(),avl_float_key(),
+      [pool,num](struct avl_node **link) -> int {
+        return pool_new_node(pool,link,num);
+      },hint);
+
+}
+
+int avl_hint_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint){
+
+    // Nodes go back to the global heap.
+    return avl_pool_hint_remove(num,new_root,hint,nullptr);
 
-    // If nullptr then create the new node.
+}
+
+int avl_pool_hint_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_node **hint,
+  struct avl_pool  *pool){
+
+    //if nullptr then avl is empty or doesnt exist.
     if (*new_root == nullptr){
-        status= new_node(new_root,num);
-        return status;
+      return AVL_NOT_FOUND;
     }
 
-    // Num smaller than current node.
-    if (num < (*new_root)->value){
-        status=avl_node_add(num,&((*new_root)->lc_node));
+    AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+    AVL_TRACE_SPAN("avl_hint_remove");
+
+    // Find the node from the finger, or from the root without one.
+    struct avl_node *start=(*hint != nullptr) ?
+      avl_detail::finger(*hint,num,avl_float_less(),avl_float_key()) : *new_root;
+    struct avl_node *node=avl_detail::find(start,num,avl_float_less(),avl_float_key());
+    if (node == nullptr){
+      return AVL_OUT_OF_RANGE;
     }
 
-    // Num greater than current node.
-    else if (num > (*new_root)->value){
-        status=avl_node_add(num,&((*new_root)->rc_node));
+    // A neighbour survives the removal and stays close to num.
+    struct avl_node *neighbour=avl_detail::next(node);
+    if (neighbour == nullptr){
+      neighbour=avl_detail::prev(node);
     }
-    else {
-        // Ignore repeated element.
-        return AVL_SUCCESS;
+    avl_detail::erase_node(new_root,node);
+    pool_free_node(pool,node);
+    *hint=neighbour;
+    return AVL_SUCCESS;
+
+}
+
+// Adds delta repetitions to node and to the totals of its ancestors.
+static void change_count(
+  struct avl_node *node,
+  int              delta){
+    node->count+=delta;
+    for (; node!=nullptr; node=node->parent){
+      node->total+=delta;
     }
-    // If invalid state, return immediately (skip balancing).
-    if (status!=0){
-        return status;
+}
+
+int avl_multi_add(
+  float num,
+  struct avl_node **new_root){
+
+    // Nodes come from the global heap.
+    return avl_pool_multi_add(num,new_root,nullptr);
+
+}
+
+int avl_pool_multi_add(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    struct avl_node *found_node;
+    bool created=false;
+    AVL_STATS_SCOPE(AVL_STATS_INSERT);
+    AVL_TRACE_SPAN("avl_multi_add");
+
+    // Same descent as avl_pool_node_add; a repeated value only counts.
+    int status=avl_detail::insert(new_root,num,avl_float_less(),avl_float_key(),
+      [pool,num,&created](struct avl_node **link) -> int {
+        created=true;
+        return pool_new_node(pool,link,num);
+      },&found_node);
+    if (status==AVL_SUCCESS && !created){
+      change_count(found_node,1);
     }
+    return status;
+
+}
 
-    // Get balance factor.
-    int balance = get_balance(*new_root);
+int avl_multi_remove(
+  float num,
+  struct avl_node **new_root){
 
-    // Left Left Case.
-    if (balance > 1 && num < (*new_root)->lc_node->value){
-        status_1=right_rotation(new_root);
-        return min(status,status_1);
+    // Nodes go back to the global heap.
+    return avl_pool_multi_remove(num,new_root,nullptr);
+
+}
+
+int avl_pool_multi_remove(
+  float num,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    //if nullptr then avl is empty or doesnt exist.
+    if (*new_root == nullptr){
+      return AVL_NOT_FOUND;
     }
 
-    // Right Right Case.
-    if (balance < -1 && num > (*new_root)->rc_node->value){
-        status_1 = left_rotation(new_root);
-        return min(status,status_1);
+    // Only the last repetition takes the node out of the tree.
+    struct avl_node *node;
+    {
+      AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+      AVL_TRACE_SPAN("avl_multi_remove");
+      node=avl_detail::find(*new_root,num,avl_float_less(),avl_float_key());
+      if (node == nullptr){
+        return AVL_OUT_OF_RANGE;
+      }
+      if (node->count > 1){
+        change_count(node,-1);
+        return AVL_SUCCESS;
+      }
     }
+    return avl_pool_node_remove(num,new_root,pool);
+
+}
+
+int avl_multi_count(
+  struct avl_node  *in_root,
+  float             num,
+  int              *count){
+
+    struct avl_node *node=avl_detail::find(in_root,num,less<float>(),avl_float_key());
+    *count=(node == nullptr) ? 0 : node->count;
+    return AVL_SUCCESS;
 
-    // Left Right Case.
-    if (balance > 1 && num > (*new_root)->lc_node->value){
-        status_1=left_rotation(&((*new_root)->lc_node));
-        status_2=right_rotation(new_root);
-        return min3(status,status_1,status_2);
+}
+
+int avl_multi_size(
+  struct avl_node *in_root){
+    return (in_root == nullptr) ? 0 : in_root->total;
+}
+
+int avl_multi_rank(
+  struct avl_node  *in_root,
+  float             num,
+  int              *rank){
+
+    // Count repetitions to the left of the descent path.
+    int smaller=0;
+    while (in_root != nullptr){
+      if (in_root->value < num){
+        smaller+=avl_multi_size(in_root->lc_node)+in_root->count;
+        in_root=in_root->rc_node;
+      }
+      else {
+        in_root=in_root->lc_node;
+      }
     }
+    *rank=smaller;
+    return AVL_SUCCESS;
 
-    // Right Left Case.
-    if (balance < -1 && num < (*new_root)->rc_node->value){
-        status_1=right_rotation(&((*new_root)->rc_node));
-        status_2=left_rotation(new_root);
-        return min3(status,status_1,status_2);
+}
+
+int avl_multi_select(
+  struct avl_node  *in_root,
+  int               k,
+  struct avl_node **found_node){
+
+    if (k < 0 || k >= avl_multi_size(in_root)){
+      return AVL_OUT_OF_RANGE;
     }
 
-    // Return status.
-    return status;
+    // Subtree totals pick a side, the node owns count positions.
+    while (k >= 0){
+      int left_total=avl_multi_size(in_root->lc_node);
+      if (k < left_total){
+        in_root=in_root->lc_node;
+      }
+      else if (k < left_total+in_root->count){
+        break;
+      }
+      else {
+        k-=left_total+in_root->count;
+        in_root=in_root->rc_node;
+      }
+    }
+    *found_node=in_root;
+    return AVL_SUCCESS;
 
 }
 
-int avl_node_remove(
-  float num,
-  struct avl_node **new_root
-){
-    int status = AVL_SUCCESS;
-    int status_1 = AVL_SUCCESS;
-    int status_2 = AVL_SUCCESS;
+int avl_insert_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root){
+
+    // Nodes come from the global heap.
+    return avl_pool_insert_batch(batch,batch_size,new_root,nullptr);
+
+}
+
+int avl_pool_insert_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    // Identify invalid batch sizes and return.
+    if (batch_size<1 || batch==nullptr){
+      return AVL_INVALID_PARAM;
+    }
+
+    // Sort the batch once, then push it down the tree.
+    AVL_STATS_SCOPE(AVL_STATS_INSERT);
+    AVL_TRACE_SPAN("avl_insert_batch");
+    vector<float> sorted=sorted_unique_copy(batch,batch_size);
+    auto make=[&sorted,pool](int index) -> struct avl_node * {
+      struct avl_node *node=nullptr;
+      pool_new_node(pool,&node,sorted[index]);
+      return node;
+    };
+    *new_root=avl_detail::insert_sorted(*new_root,sorted.data(),0,
+                                        static_cast<int>(sorted.size()),
+                                        avl_float_less(),avl_float_key(),make);
+    return AVL_SUCCESS;
+
+}
+
+int avl_remove_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root){
+
+    // Nodes go back to the global heap.
+    return avl_pool_remove_batch(batch,batch_size,new_root,nullptr);
+
+}
+
+int avl_pool_remove_batch(
+  float           *batch,
+  int              batch_size,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    // Identify invalid batch sizes and return.
+    if (batch_size<1 || batch==nullptr){
+      return AVL_INVALID_PARAM;
+    }
 
     //if nullptr then avl is empty or doesnt exist.
     if (*new_root == nullptr){
       return AVL_NOT_FOUND;
     }
 
+    // Sort the batch once, then push it down the tree.
+    AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+    AVL_TRACE_SPAN("avl_remove_batch");
+    vector<float> sorted=sorted_unique_copy(batch,batch_size);
+    auto release=[pool](struct avl_node *node){
+      pool_free_node(pool,node);
+    };
+    int removed=0;
+    *new_root=avl_detail::erase_sorted(*new_root,sorted.data(),0,
+                                       static_cast<int>(sorted.size()),
+                                       avl_float_less(),avl_float_key(),release,
+                                       &removed);
+
+    // Report values that were not part of the tree.
+    if (removed!=static_cast<int>(sorted.size())){
+      return AVL_OUT_OF_RANGE;
+    }
+    return AVL_SUCCESS;
 
-    // Num smaller than current node.
-    if (num < (*new_root)->value){
-        if((*new_root)->lc_node==nullptr){
-          return AVL_OUT_OF_RANGE;
-        }
-        status=avl_node_remove(num,&((*new_root)->lc_node));
+}
+
+// Frees nodes dropped by the set operations, safe to call from any thread.
+static void delete_node(
+  struct avl_node *node){
+    AVL_STATS_FREE(1,sizeof(struct avl_node));
+    delete node;
+}
+
+int avl_union(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count){
+
+    // At least the calling thread is needed.
+    if (thread_count<1){
+      return AVL_INVALID_PARAM;
     }
 
-    // Num greater than current node.
-    else if (num > (*new_root)->value){
-        if((*new_root)->rc_node==nullptr){
-          return AVL_OUT_OF_RANGE;
-        }
-        status=avl_node_remove(num,&((*new_root)->rc_node));
+    *new_root=avl_detail::set_union(first_root,second_root,less<float>(),
+                                    avl_float_key(),delete_node,
+                                    avl_detail::spawn_depth(thread_count));
+    return AVL_SUCCESS;
+
+}
+
+int avl_intersection(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count){
+
+    // At least the calling thread is needed.
+    if (thread_count<1){
+      return AVL_INVALID_PARAM;
     }
 
-    //Element to be delete found.
-    else {
-        //Delete actions for a node with one child or none
-        if ((*new_root)->rc_node == nullptr ||
-            (*new_root)->lc_node == nullptr){
-
-          struct avl_node *temp=(*new_root)->rc_node?
-                                  (*new_root)->rc_node:
-                                  (*new_root)->lc_node;
-          //the node has none children.
-          if (temp==nullptr){
-            *new_root=nullptr;
-          }
-
-          else {
-            //Then the only child will remplace the node.
-            (*new_root)->lc_node=temp->lc_node;
-            (*new_root)->rc_node=temp->rc_node;
-            (*new_root)->value=temp->value;
-          }
-          delete temp;
-        }
-        else {
-          //Else, the node has left and right children.
-          struct avl_node *temp=nullptr;
-          status=avl_min_get((*new_root)->rc_node,&temp);
-          //Move the right min value to the new_root and delete that leaf.
-          (*new_root)->value=temp->value;
-          avl_node_remove(temp->value,&((*new_root)->rc_node));
-
-          delete temp;
-        }
+    *new_root=avl_detail::set_intersection(first_root,second_root,less<float>(),
+                                           avl_float_key(),delete_node,
+                                           avl_detail::spawn_depth(thread_count));
+    return AVL_SUCCESS;
+
+}
+
+int avl_difference(
+  struct avl_node  *first_root,
+  struct avl_node  *second_root,
+  struct avl_node **new_root,
+  int               thread_count){
+
+    // At least the calling thread is needed.
+    if (thread_count<1){
+      return AVL_INVALID_PARAM;
     }
 
-    //Tree with only one node
-    if (*new_root == nullptr){
-      return AVL_SUCCESS;
+    *new_root=avl_detail::set_difference(first_root,second_root,less<float>(),
+                                         avl_float_key(),delete_node,
+                                         avl_detail::spawn_depth(thread_count));
+    return AVL_SUCCESS;
+
+}
+
+int avl_split(
+  struct avl_node **in_root,
+  float             num,
+  struct avl_node **left,
+  struct avl_node **right){
+
+    AVL_TRACE_SPAN("avl_split");
+
+    // The node equal to num (if any) is the smallest of right.
+    struct avl_node *found=avl_detail::split(*in_root,num,avl_float_less(),
+                                             avl_float_key(),left,right);
+    if (found!=nullptr){
+      *right=avl_detail::join(static_cast<struct avl_node *>(nullptr),found,*right);
     }
+    *in_root=nullptr;
+    return AVL_SUCCESS;
+
+}
 
-    // Get balance factor.
-    int balance=get_balance(*new_root);
+int avl_join(
+  struct avl_node  *left,
+  float             num,
+  struct avl_node  *right,
+  struct avl_node **new_root){
 
-    // Left Left Case.
-    if (balance > 1 && get_balance((*new_root)->lc_node)>=0){
-        status_1=right_rotation(new_root);
-        return min(status,status_1);
+    // Nodes come from the global heap.
+    return avl_pool_join(left,num,right,new_root,nullptr);
+
+}
+
+int avl_pool_join(
+  struct avl_node  *left,
+  float             num,
+  struct avl_node  *right,
+  struct avl_node **new_root,
+  struct avl_pool  *pool){
+
+    // Every value of left must be below num and every one of right above.
+    if ((left!=nullptr && !(avl_detail::rightmost(left)->value<num)) ||
+        (right!=nullptr && !(num<avl_detail::leftmost(right)->value))){
+      return AVL_INVALID_PARAM;
     }
 
-    // Right Right Case.
-    if (balance < -1 && get_balance((*new_root)->rc_node)<=0){
-        status_1=left_rotation(new_root);
-        return min(status,status_1);
+    AVL_TRACE_SPAN("avl_join");
+    struct avl_node *mid=nullptr;
+    int status=pool_new_node(pool,&mid,num);
+    if (status!=AVL_SUCCESS){
+      return status;
     }
+    *new_root=avl_detail::join(left,mid,right);
+    return AVL_SUCCESS;
 
+}
 
-    // Left Right Case.
-    if (balance > 1 && get_balance((*new_root)->lc_node)<0){
-        status_1=left_rotation(&((*new_root)->lc_node));
-        status_2=right_rotation(new_root);
-        return min3(status,status_1,status_2);
+// Takes [low, high) out of the tree with two splits and one join, and
+// returns it as a tree of its own.
+static struct avl_node *cut_range(
+  float             low,
+  float             high,
+  struct avl_node **root){
+
+    struct avl_node *left;
+    struct avl_node *middle;
+    struct avl_node *right;
+    avl_split(root,low,&left,&middle);
+    struct avl_node *rest=middle;
+    avl_split(&rest,high,&middle,&right);
+    *root=avl_detail::join2(left,right);
+    return middle;
+}
+
+int avl_erase_range(
+  float             low,
+  float             high,
+  struct avl_node **new_root,
+  int               free_mode,
+  int              *removed){
+
+    if (high<low || (free_mode!=AVL_FREE_NOW && free_mode!=AVL_FREE_BACKGROUND)){
+      return AVL_INVALID_PARAM;
     }
 
-    // Right Left Case.
-    if (balance < -1 && get_balance((*new_root)->rc_node)>0){
-        status_1=right_rotation(&((*new_root)->rc_node));
-        status_2=left_rotation(new_root);
-        return min3(status,status_1,status_2);
+    //if nullptr then avl is empty or doesnt exist.
+    if (*new_root == nullptr){
+      return AVL_NOT_FOUND;
     }
-    //Return status
-    return status;
+
+    struct avl_node *middle;
+    {
+      AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+      AVL_TRACE_SPAN("avl_erase_range");
+      middle=cut_range(low,high,new_root);
+    }
+    if (removed!=nullptr){
+      *removed=get_size(middle);
+    }
+
+    // Freeing is the only part linear in the number of removed values.
+    if (free_mode==AVL_FREE_BACKGROUND){
+      avl_background_free(middle);
+    }
+    else {
+      free_tree_mem(middle);
+    }
+    return AVL_SUCCESS;
+
+}
+
+int avl_pool_erase_range(
+  float             low,
+  float             high,
+  struct avl_node **new_root,
+  struct avl_pool  *pool,
+  int              *removed){
+
+    if (high<low){
+      return AVL_INVALID_PARAM;
+    }
+
+    //if nullptr then avl is empty or doesnt exist.
+    if (*new_root == nullptr){
+      return AVL_NOT_FOUND;
+    }
+
+    AVL_STATS_SCOPE(AVL_STATS_REMOVE);
+    AVL_TRACE_SPAN("avl_erase_range");
+    struct avl_node *middle=cut_range(low,high,new_root);
+    if (removed!=nullptr){
+      *removed=get_size(middle);
+    }
+
+    // The pool is not shared with other threads, nodes go back here.
+    avl_detail::destroy(middle,[pool](struct avl_node *node){
+      avl_pool_free_node(pool,node);
+    });
+    return AVL_SUCCESS;
+
 }
 
 int avl_search(float num, struct avl_node **root, struct avl_node **found_node){
-  int status = AVL_SUCCESS;
-  
+
   //if nullptr then avl is empty or doesnt exist.
   if (*root == nullptr){
     return AVL_NOT_FOUND;
   }
 
-  // Num smaller than current node.
-  if (num < (*root)->value){
-      if((*root)->lc_node==nullptr){
-        return AVL_OUT_OF_RANGE;
-      }
-      status=avl_search(num,&((*root)->lc_node), found_node);
-  }
-
-  // Num greater than current node.
-  else if (num > (*root)->value){
-      if((*root)->rc_node==nullptr){
-        return AVL_OUT_OF_RANGE;
-      }
-      status=avl_search(num,&((*root)->rc_node), found_node);
-  }
-
-  //Element to be delete found.
-  else {
-    *found_node = *root;
+  // Descend until the value is found or a leaf is passed.
+  AVL_STATS_SCOPE(AVL_STATS_SEARCH);
+  AVL_TRACE_SPAN("avl_search");
+  struct avl_node *node=avl_detail::find(*root,num,avl_float_less(),avl_float_key());
+  if (node == nullptr){
+    return AVL_OUT_OF_RANGE;
   }
 
-  return status;
+  *found_node = node;
+  return AVL_SUCCESS;
 }
 
 float *random_list(
@@ -414,29 +1095,117 @@ float *random_list(
 
 void free_tree_mem(
   struct avl_node *root_node){
-    // Post order traversal guarantees bottom up memory disallocation
-    // to prevent memory leaks.
-    if (root_node!=nullptr){
-        free_tree_mem(root_node->lc_node);
-        free_tree_mem(root_node->rc_node);
-        delete root_node;
+    // Flatten the tree with rotations while freeing, no recursion and no
+    // extra memory.
+    AVL_TRACE_SPAN("free_tree_mem");
+    avl_detail::destroy(root_node,[](struct avl_node *node){
+      AVL_STATS_FREE(1,sizeof(struct avl_node));
+      delete node;
+    });
+
+}
+
+// Trees waiting for the background thread, which starts with the first
+// one and is joined at exit after freeing everything still queued.
+struct background_freer {
+  mutex                     lock;
+  condition_variable        wake;
+  condition_variable        idle;
+  vector<struct avl_node *> pending;
+  bool                      busy=false;
+  bool                      stopping=false;
+  thread                    worker;
+
+  ~background_freer(){
+      {
+        lock_guard<mutex> guard(lock);
+        stopping=true;
+      }
+      wake.notify_all();
+      if (worker.joinable()){
+        worker.join();
+      }
+  }
+
+  void run(){
+      unique_lock<mutex> guard(lock);
+      while (true){
+        wake.wait(guard,[this](){ return stopping || !pending.empty(); });
+        if (pending.empty()){
+          return;
+        }
+
+        // Free the whole queue outside the lock.
+        vector<struct avl_node *> batch;
+        batch.swap(pending);
+        busy=true;
+        guard.unlock();
+        for (size_t index = 0; index < batch.size(); index++){
+          free_tree_mem(batch[index]);
+        }
+        guard.lock();
+        busy=false;
+        if (pending.empty()){
+          idle.notify_all();
+        }
+      }
+  }
+};
+
+static struct background_freer &freer(){
+    static struct background_freer instance;
+    return instance;
+}
+
+void avl_background_free(
+  struct avl_node *root_node){
+
+    if (root_node==nullptr){
+      return;
+    }
+
+    struct background_freer &target=freer();
+    {
+      lock_guard<mutex> guard(target.lock);
+      target.pending.push_back(root_node);
+      if (!target.worker.joinable()){
+        target.worker=thread(&background_freer::run,&target);
+      }
     }
+    target.wake.notify_one();
 
 }
 
-int avl_print(
-  struct avl_node  *in_root){
+void avl_background_wait(){
 
-  // Print type of traversal.
-  cout<<"Pre-order traversal: ";
+    struct background_freer &target=freer();
+    unique_lock<mutex> guard(target.lock);
+    target.idle.wait(guard,[&target](){
+      return target.pending.empty() && !target.busy;
+    });
 
-  // Call node printing
-  int status=avl_print_nodes(in_root);
+}
+
+// Appends a value to the string given as context, formatted like cout.
+static int append_value(
+  struct avl_node *node,
+  void            *context){
+    char text[32];
+    int length=snprintf(text,sizeof(text),"%g ",node->value);
+    static_cast<string *>(context)->append(text,length);
+    return AVL_SUCCESS;
+}
+
+int avl_print(
+  struct avl_node  *in_root){
 
-  // Add end of line to the printed values.
-  cout<<endl;
+  // Format the whole traversal first, then write it at once.
+  string text="Pre-order traversal: ";
+  int status=avl_traverse(in_root,AVL_PRE_ORDER,append_value,&text);
+  text+='\n';
+  cout<<text<<flush;
 
-  // Return the status given by node printing.
+  // Return the status given by the traversal.
   return status;
 
 }
@@ -445,14 +1214,40 @@ int avl_print_nodes(
   struct avl_node  *in_root){
 
     // Pre order traversal printing, to include shape information.
-    if (in_root!=nullptr){
-        cout<<in_root->value<<" ";
-        avl_print_nodes(in_root->lc_node);
-        avl_print_nodes(in_root->rc_node);
-    }
+    string text;
+    int status=avl_traverse(in_root,AVL_PRE_ORDER,append_value,&text);
+    cout<<text;
+    return status;
 
-    // Return success.
-    return AVL_SUCCESS;
+}
+
+int avl_traverse(
+  struct avl_node  *in_root,
+  int               order,
+  avl_visitor       visit,
+  void             *context){
+
+  if(visit == nullptr){
+    return AVL_INVALID_PARAM;
+  }
+
+  auto call=[visit, context](struct avl_node *node) -> int {
+    return visit(node, context);
+  };
+  switch(order){
+    case AVL_PRE_ORDER:
+      return avl_detail::pre_order(in_root, call);
+    case AVL_IN_ORDER:
+      return avl_detail::in_order(in_root, call);
+    case AVL_LEVEL_ORDER:
+      return avl_detail::level_order(in_root, call);
+    case AVL_MORRIS_PRE_ORDER:
+      return avl_detail::morris(in_root, true, call);
+    case AVL_MORRIS_IN_ORDER:
+      return avl_detail::morris(in_root, false, call);
+    default:
+      return AVL_INVALID_PARAM;
+  }
 
 }
 
@@ -464,31 +1259,190 @@ int avl_max_get(struct avl_node *in_root, struct avl_node **max_node){
     return AVL_OUT_OF_RANGE;
   }
 
-  if(in_root != nullptr){
-    (*max_node) = in_root;
-    avl_max_get(in_root->rc_node, (max_node));
+  // Follow the right spine.
+  (*max_node) = avl_detail::rightmost(in_root);
+  return AVL_SUCCESS;
+
+}
+
+
+int avl_min_get(struct avl_node *in_root, struct avl_node **min_node){
+
+  if(in_root == nullptr){
+    return AVL_OUT_OF_RANGE;
   }
-  if((*max_node) == nullptr) return AVL_OUT_OF_RANGE;
+
+  // Follow the left spine.
+  (*min_node) = avl_detail::leftmost(in_root);
   return AVL_SUCCESS;
 
+}
+
 
+int avl_rank(struct avl_node *in_root, float num, int *rank){
+
+  // Count values to the left of the descent path.
+  *rank = avl_detail::rank(in_root, num, less<float>(), avl_float_key());
+  return AVL_SUCCESS;
 
 }
 
 
-int avl_min_get(struct avl_node *in_root, struct avl_node **min_node){
+int avl_select(struct avl_node *in_root, int k, struct avl_node **found_node){
+
+  // Use subtree sizes to pick a side at every level.
+  struct avl_node *node = avl_detail::select(in_root, k);
+  if(node == nullptr){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  (*found_node) = node;
+  return AVL_SUCCESS;
+
+}
+
+
+int avl_median(struct avl_node *in_root, float *median_value){
+
+  int tree_size = get_size(in_root);
+  if(tree_size == 0){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  // Odd sizes have a single middle element.
+  struct avl_node *upper = avl_detail::select(in_root, tree_size / 2);
+  if(tree_size % 2 != 0){
+    (*median_value) = upper->value;
+    return AVL_SUCCESS;
+  }
+
+  // Even sizes average both middle elements.
+  struct avl_node *lower = avl_detail::select(in_root, tree_size / 2 - 1);
+  (*median_value) = (lower->value + upper->value) / 2.0;
+  return AVL_SUCCESS;
+
+}
 
+
+// Turns the result of a bound query into a status code.
+static int bound_status(struct avl_node *in_root, struct avl_node *node,
+                        struct avl_node **found_node){
+
+  //if nullptr then avl is empty or doesnt exist.
   if(in_root == nullptr){
+    return AVL_NOT_FOUND;
+  }
+
+  // No value satisfies the bound.
+  if(node == nullptr){
     return AVL_OUT_OF_RANGE;
   }
 
-  if(in_root != nullptr){
-    (*min_node) = in_root;
-    avl_min_get(in_root->lc_node, (min_node));
+  (*found_node) = node;
+  return AVL_SUCCESS;
+
+}
+
+
+int avl_lower_bound(struct avl_node *in_root, float num, struct avl_node **found_node){
+
+  return bound_status(in_root,
+    avl_detail::lower_bound(in_root, num, less<float>(), avl_float_key()),
+    found_node);
+
+}
+
+
+int avl_upper_bound(struct avl_node *in_root, float num, struct avl_node **found_node){
+
+  return bound_status(in_root,
+    avl_detail::upper_bound(in_root, num, less<float>(), avl_float_key()),
+    found_node);
+
+}
+
+
+int avl_floor(struct avl_node *in_root, float num, struct avl_node **found_node){
+
+  return bound_status(in_root,
+    avl_detail::floor(in_root, num, less<float>(), avl_float_key()),
+    found_node);
+
+}
+
+
+int avl_ceiling(struct avl_node *in_root, float num, struct avl_node **found_node){
+
+  // Smallest value not below num.
+  return avl_lower_bound(in_root, num, found_node);
+
+}
+
+
+int avl_range_count(struct avl_node *in_root, float low, float high, int *count){
+
+  // Only reversed ranges (low > high) are rejected; low == high is an empty
+  // range with count 0.
+  if(high < low){
+    return AVL_INVALID_PARAM;
+  }
+
+  // Values below high minus values below low.
+  int low_rank = avl_detail::rank(in_root, low, less<float>(), avl_float_key());
+  int high_rank = avl_detail::rank(in_root, high, less<float>(), avl_float_key());
+  (*count) = high_rank - low_rank;
+  return AVL_SUCCESS;
+
+}
+
+
+int avl_range_scan(struct avl_node *in_root, float low, float high,
+                   avl_visitor visit, void *context){
+
+  if(visit == nullptr || high < low){
+    return AVL_INVALID_PARAM;
+  }
+
+  // Only the path to low and the matching nodes are touched.
+  return avl_detail::range_scan(in_root, low, high, less<float>(), avl_float_key(),
+    [visit, context](struct avl_node *node) -> int {
+      return visit(node, context);
+    });
+
+}
+
+
+int avl_next(struct avl_node *node, struct avl_node **next_node){
+
+  if(node == nullptr){
+    return AVL_INVALID_PARAM;
+  }
+
+  // Leftmost of the right subtree, or the first ancestor to the right.
+  struct avl_node *next = avl_detail::next(node);
+  if(next == nullptr){
+    return AVL_OUT_OF_RANGE;
   }
 
-  if((*min_node) == nullptr) return AVL_OUT_OF_RANGE;
+  (*next_node) = next;
   return AVL_SUCCESS;
 
+}
+
+
+int avl_prev(struct avl_node *node, struct avl_node **prev_node){
+
+  if(node == nullptr){
+    return AVL_INVALID_PARAM;
+  }
+
+  // Rightmost of the left subtree, or the first ancestor to the left.
+  struct avl_node *prev = avl_detail::prev(node);
+  if(prev == nullptr){
+    return AVL_OUT_OF_RANGE;
+  }
+
+  (*prev_node) = prev;
+  return AVL_SUCCESS;
 
 }
@@ -0,0 +1,83 @@
+#include "AVL_compact.hpp"
+#include "gtest/gtest.h"
+#include <set>
+
+using namespace std;
+
+// Recomputes subtree heights and checks the packed balance factors.
+// Returns the real height or -1 on mismatch.
+static int check_compact(const struct avl_compact_tree *tree, uint32_t index){
+    if (index==AVL_COMPACT_NIL){
+        return 0;
+    }
+    const struct avl_compact_node &node=tree->nodes[index];
+    int left_height=check_compact(tree,avl_compact_lc(node));
+    int right_height=check_compact(tree,avl_compact_rc(node));
+    if (left_height<0 || right_height<0 ||
+        left_height-right_height!=avl_compact_balance(node)){
+        return -1;
+    }
+    return max(left_height,right_height)+1;
+}
+
+// Nodes must take 12 bytes.
+TEST(Compact_layout,positive){
+  EXPECT_EQ(sizeof(struct avl_compact_node),12u);
+}
+
+// Random adds and removes must match std::set and keep the tree balanced.
+TEST(Compact_test,positive){
+  struct avl_compact_tree tree;
+  set<float> reference;
+  uint32_t found_index;
+
+  EXPECT_EQ(avl_compact_init(&tree,4),AVL_SUCCESS);
+  srand(7);
+  for (int index = 0; index < 5000; index++){
+    float value=static_cast<float>(rand()%1000);
+    if (rand()%3==0){
+      int status=avl_compact_remove(value,&tree);
+      EXPECT_EQ(status==AVL_SUCCESS,reference.erase(value)==1);
+    }
+    else {
+      EXPECT_EQ(avl_compact_add(value,&tree),AVL_SUCCESS);
+      reference.insert(value);
+    }
+  }
+  EXPECT_GE(check_compact(&tree,tree.root),0);
+  EXPECT_EQ(tree.size,reference.size());
+
+  // Every value of the reference is found.
+  for (set<float>::iterator it = reference.begin(); it != reference.end(); ++it){
+    EXPECT_EQ(avl_compact_search(*it,&tree,&found_index),AVL_SUCCESS);
+    EXPECT_EQ(tree.nodes[found_index].value,*it);
+  }
+
+  // Min and max match the reference.
+  EXPECT_EQ(avl_compact_min_get(&tree,&found_index),AVL_SUCCESS);
+  EXPECT_EQ(tree.nodes[found_index].value,*reference.begin());
+  EXPECT_EQ(avl_compact_max_get(&tree,&found_index),AVL_SUCCESS);
+  EXPECT_EQ(tree.nodes[found_index].value,*reference.rbegin());
+
+  avl_compact_free(&tree);
+}
+
+// Empty trees and missing values report the same codes as the pointer tree.
+TEST(Compact_test,negative){
+  struct avl_compact_tree tree;
+  uint32_t found_index;
+  float list[3]={1,2,3};
+
+  EXPECT_EQ(avl_compact_init(&tree,0),AVL_SUCCESS);
+  EXPECT_EQ(avl_compact_remove(1,&tree),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_compact_search(1,&tree,&found_index),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_compact_min_get(&tree,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_compact_max_get(&tree,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_compact_create(list,0,&tree),AVL_INVALID_PARAM);
+
+  EXPECT_EQ(avl_compact_create(list,3,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_compact_remove(4,&tree),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_compact_search(0,&tree,&found_index),AVL_OUT_OF_RANGE);
+
+  avl_compact_free(&tree);
+}
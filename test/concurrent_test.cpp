@@ -0,0 +1,151 @@
+#include "AVL_concurrent.hpp"
+#include "gtest/gtest.h"
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Checks order, parent links and heights of a quiescent concurrent tree and
+// appends the present values in order. Returns the real height or -1 on
+// mismatch.
+static int check_concurrent(struct avl_cnode *node, struct avl_cnode *parent,
+                            vector<float> &values){
+    if (node==nullptr){
+        return 0;
+    }
+    if (node->parent.load()!=parent){
+        return -1;
+    }
+    int left_height=check_concurrent(node->lc_node.load(),node,values);
+    if (node->present.load()){
+        values.push_back(node->value);
+    }
+    int right_height=check_concurrent(node->rc_node.load(),node,values);
+    int balance=left_height-right_height;
+    if (left_height<0 || right_height<0 || balance>1 || balance<-1){
+        return -1;
+    }
+    int height=max(left_height,right_height)+1;
+    return (height==node->height.load()) ? height : -1;
+}
+
+// Writers on private and shared key ranges race with lock-free readers;
+// afterwards the tree must be balanced and hold exactly the expected keys.
+TEST(Concurrent_test,stress){
+  const int thread_count=8;
+  const int operations=20000;
+  struct avl_concurrent_tree tree;
+  vector<set<float> > owned(thread_count);
+  vector<int> failures(thread_count,0);
+
+  avl_concurrent_init(&tree);
+
+  // Keys below zero are never removed, readers must always find them.
+  for (int value = 1; value <= 200; value++){
+    EXPECT_EQ(avl_concurrent_add(static_cast<float>(-value),&tree),AVL_SUCCESS);
+  }
+
+  vector<thread> workers;
+  for (int worker = 0; worker < thread_count; worker++){
+    workers.push_back(thread([&tree,&owned,&failures,worker](){
+      unsigned int seed=static_cast<unsigned int>(worker)*7919u+1u;
+      for (int index = 0; index < operations; index++){
+        seed=seed*1103515245u+12345u;
+        unsigned int draw=(seed >> 8) % 1000u;
+        int kind=index%4;
+
+        if (kind==0){
+          // Reads of stable keys never miss.
+          float stable=-static_cast<float>(draw%200+1);
+          if (avl_concurrent_search(stable,&tree)!=AVL_SUCCESS){
+            failures[worker]++;
+          }
+        }
+        else if (kind==3){
+          // Shared keys: any outcome is valid, only the structure matters.
+          float shared=static_cast<float>(100000+draw%64);
+          if (draw%2==0){
+            avl_concurrent_add(shared,&tree);
+          }
+          else {
+            avl_concurrent_remove(shared,&tree);
+          }
+        }
+        else {
+          // Private keys: results must match the local reference.
+          float key=static_cast<float>(worker*1000+static_cast<int>(draw%500));
+          if (draw%3==0){
+            int status=avl_concurrent_remove(key,&tree);
+            if ((status==AVL_SUCCESS)!=(owned[worker].erase(key)==1)){
+              failures[worker]++;
+            }
+          }
+          else {
+            avl_concurrent_add(key,&tree);
+            owned[worker].insert(key);
+          }
+          if (avl_concurrent_search(key,&tree)!=
+              (owned[worker].count(key) ? AVL_SUCCESS : AVL_OUT_OF_RANGE)){
+            failures[worker]++;
+          }
+        }
+      }
+    }));
+  }
+  for (int worker = 0; worker < thread_count; worker++){
+    workers[worker].join();
+    EXPECT_EQ(failures[worker],0);
+  }
+
+  // Drop the shared keys, then compare with the union of private keys.
+  for (int value = 100000; value < 100064; value++){
+    avl_concurrent_remove(static_cast<float>(value),&tree);
+  }
+  set<float> expected;
+  for (int value = 1; value <= 200; value++){
+    expected.insert(static_cast<float>(-value));
+  }
+  for (int worker = 0; worker < thread_count; worker++){
+    expected.insert(owned[worker].begin(),owned[worker].end());
+  }
+
+  vector<float> values;
+  EXPECT_GE(check_concurrent(tree.holder->rc_node.load(),tree.holder,values),0);
+  EXPECT_EQ(values.size(),expected.size());
+  EXPECT_TRUE(equal(values.begin(),values.end(),expected.begin()));
+  // Finished operations already freed almost every unlinked node.
+  EXPECT_LE(avl_concurrent_reclaim(&tree),2);
+  avl_concurrent_free(&tree);
+}
+
+// Steady adds and removes free unlinked nodes without a quiescent reclaim.
+TEST(Concurrent_test,reclaim){
+  struct avl_concurrent_tree tree;
+
+  avl_concurrent_init(&tree);
+  for (int index = 0; index < 10000; index++){
+    EXPECT_EQ(avl_concurrent_add(static_cast<float>(index%7),&tree),AVL_SUCCESS);
+    EXPECT_EQ(avl_concurrent_remove(static_cast<float>(index%7),&tree),AVL_SUCCESS);
+  }
+  EXPECT_EQ(avl_concurrent_search(0,&tree),AVL_NOT_FOUND);
+  EXPECT_LE(avl_concurrent_reclaim(&tree),2);
+  avl_concurrent_free(&tree);
+}
+
+// Empty trees and missing values report the same codes as the pointer tree.
+TEST(Concurrent_test,negative){
+  struct avl_concurrent_tree tree;
+
+  avl_concurrent_init(&tree);
+  EXPECT_EQ(avl_concurrent_search(1,&tree),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_concurrent_remove(1,&tree),AVL_NOT_FOUND);
+
+  EXPECT_EQ(avl_concurrent_add(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_concurrent_add(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_concurrent_search(0,&tree),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_concurrent_remove(2,&tree),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_concurrent_remove(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_concurrent_remove(1,&tree),AVL_NOT_FOUND);
+  avl_concurrent_free(&tree);
+}
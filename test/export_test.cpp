@@ -0,0 +1,123 @@
+#include "AVL_export.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Appends every visited value to the vector given as context.
+static int collect_order(struct avl_node *node, void *context){
+    static_cast<vector<float> *>(context)->push_back(node->value);
+    return AVL_SUCCESS;
+}
+
+// Stops the traversal after the fifth value.
+static int stop_after_five(struct avl_node *node, void *context){
+    vector<float> *values=static_cast<vector<float> *>(context);
+    values->push_back(node->value);
+    return (values->size()<5) ? AVL_SUCCESS : AVL_TIMEOUT;
+}
+
+// Every order visits the well known tree built from 10..100.
+TEST(Traverse_test,positive){
+  float list[10]={10,20,30,40,50,60,70,80,90,100};
+  float pre[10]={40,20,10,30,80,60,50,70,90,100};
+  float level[10]={40,20,80,10,30,60,90,50,70,100};
+  struct avl_node *root=nullptr;
+  EXPECT_EQ(avl_create(list,10,&root),AVL_SUCCESS);
+
+  vector<float> values;
+  EXPECT_EQ(avl_traverse(root,AVL_PRE_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),pre));
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_MORRIS_PRE_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),pre));
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_IN_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),list));
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_MORRIS_IN_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),list));
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_LEVEL_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),level));
+
+  // A Morris traversal stopped early leaves no threads behind.
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_MORRIS_IN_ORDER,stop_after_five,&values),AVL_TIMEOUT);
+  EXPECT_EQ(values.size(),5u);
+  values.clear();
+  EXPECT_EQ(avl_traverse(root,AVL_LEVEL_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),level));
+
+  free_tree_mem(root);
+}
+
+// Text and binary exports read back as the in-order values.
+TEST(Export_test,positive){
+  const char *path="export_test.out";
+  struct avl_node *root=nullptr;
+  vector<float> expected;
+
+  srand(23);
+  for (int index = 0; index < 20000; index++){
+    float value=(index%2==0) ? static_cast<float>(rand()%100000-50000) :
+                               static_cast<float>(rand())/7;
+    avl_node_add(value,&root);
+  }
+  avl_traverse(root,AVL_IN_ORDER,collect_order,&expected);
+
+  int fd=open(path,O_WRONLY | O_CREAT | O_TRUNC,0644);
+  ASSERT_GE(fd,0);
+  EXPECT_EQ(avl_export(root,AVL_IN_ORDER,fd,AVL_EXPORT_TEXT),AVL_SUCCESS);
+  close(fd);
+  ifstream text_file(path);
+  vector<float> values;
+  float value;
+  while (text_file >> value){
+    values.push_back(value);
+  }
+  EXPECT_EQ(values,expected);
+
+  fd=open(path,O_WRONLY | O_CREAT | O_TRUNC,0644);
+  ASSERT_GE(fd,0);
+  EXPECT_EQ(avl_export(root,AVL_IN_ORDER,fd,AVL_EXPORT_BINARY),AVL_SUCCESS);
+  close(fd);
+  ifstream binary_file(path,ios::binary);
+  values.assign(expected.size(),0);
+  binary_file.read(reinterpret_cast<char *>(values.data()),values.size()*sizeof(float));
+  EXPECT_EQ(binary_file.gcount(),static_cast<streamsize>(values.size()*sizeof(float)));
+  EXPECT_EQ(values,expected);
+
+  free_tree_mem(root);
+  remove(path);
+}
+
+// Unknown orders and formats, missing visitors and closed descriptors.
+TEST(Export_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_writer writer;
+  vector<float> values;
+
+  EXPECT_EQ(avl_traverse(root,AVL_IN_ORDER,collect_order,&values),AVL_SUCCESS);
+  EXPECT_TRUE(values.empty());
+  avl_node_add(1,&root);
+  EXPECT_EQ(avl_traverse(root,7,collect_order,&values),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_traverse(root,AVL_IN_ORDER,nullptr,&values),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_export(root,AVL_IN_ORDER,-1,AVL_EXPORT_TEXT),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_export(root,AVL_IN_ORDER,1,5),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_writer_init(&writer,1,AVL_EXPORT_TEXT,4),AVL_INVALID_PARAM);
+
+  // Writing to a descriptor that is not open fails on flush.
+  int fd=open("export_negative.out",O_WRONLY | O_CREAT | O_TRUNC,0644);
+  ASSERT_GE(fd,0);
+  close(fd);
+  EXPECT_EQ(avl_export(root,AVL_IN_ORDER,fd,AVL_EXPORT_TEXT),AVL_OUT_OF_RANGE);
+  remove("export_negative.out");
+
+  free_tree_mem(root);
+}
@@ -0,0 +1,143 @@
+#include "AVL_forest.hpp"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Appends every visited value to the vector given as context.
+static int collect_forest(struct avl_node *node, void *context){
+    static_cast<vector<float> *>(context)->push_back(node->value);
+    return AVL_SUCCESS;
+}
+
+// Skewed inserts move the shard bounds, and queries still see one ordered
+// set of values.
+TEST(Forest_test,positive){
+  struct avl_forest forest;
+  set<float> reference;
+  float found_value=0;
+
+  // Every value lands in the first of the initial intervals.
+  EXPECT_EQ(avl_forest_init(&forest,4,0,40000),AVL_SUCCESS);
+  srand(17);
+  for (int index = 0; index < 6000; index++){
+    float value=static_cast<float>(rand()%3000);
+    if (rand()%4==0){
+      int status=avl_forest_remove(value,&forest);
+      EXPECT_EQ(status==AVL_SUCCESS,reference.erase(value)==1);
+    }
+    else {
+      EXPECT_EQ(avl_forest_add(value,&forest),AVL_SUCCESS);
+      reference.insert(value);
+    }
+  }
+  EXPECT_EQ(forest.size.load(),static_cast<int>(reference.size()));
+
+  // The first shard no longer holds everything.
+  EXPECT_LT(forest.shards[0].size.load(),static_cast<int>(reference.size()));
+  EXPECT_EQ(avl_forest_rebalance(&forest),AVL_SUCCESS);
+  for (int index = 0; index < forest.shard_count; index++){
+    EXPECT_LE(forest.shards[index].size.load(),
+              static_cast<int>(reference.size())/forest.shard_count+1);
+  }
+
+  for (set<float>::iterator it = reference.begin(); it != reference.end(); ++it){
+    EXPECT_EQ(avl_forest_search(*it,&forest),AVL_SUCCESS);
+  }
+  EXPECT_EQ(avl_forest_min_get(&forest,&found_value),AVL_SUCCESS);
+  EXPECT_EQ(found_value,*reference.begin());
+  EXPECT_EQ(avl_forest_max_get(&forest,&found_value),AVL_SUCCESS);
+  EXPECT_EQ(found_value,*reference.rbegin());
+
+  // Scans cross shard bounds in order.
+  vector<float> values;
+  EXPECT_EQ(avl_forest_range_scan(&forest,100,2900,collect_forest,&values),AVL_SUCCESS);
+  EXPECT_TRUE(equal(values.begin(),values.end(),reference.lower_bound(100)));
+  EXPECT_EQ(values.size(),static_cast<size_t>(
+    distance(reference.lower_bound(100),reference.lower_bound(2900))));
+
+  avl_forest_free(&forest);
+}
+
+// Writers on different ranges run in parallel with automatic rebalancing.
+TEST(Forest_test,concurrent){
+  struct avl_forest forest;
+  const int thread_count=4;
+  const int per_thread=5000;
+
+  EXPECT_EQ(avl_forest_init(&forest,8,0,100000),AVL_SUCCESS);
+  vector<thread> writers;
+  for (int writer = 0; writer < thread_count; writer++){
+    writers.push_back(thread([&forest,writer](){
+      for (int index = 0; index < per_thread; index++){
+        avl_forest_add(static_cast<float>(index*thread_count+writer),&forest);
+        if (index%3==0){
+          avl_forest_search(static_cast<float>(index*thread_count),&forest);
+        }
+      }
+    }));
+  }
+  for (int writer = 0; writer < thread_count; writer++){
+    writers[writer].join();
+  }
+
+  vector<float> values;
+  EXPECT_EQ(forest.size.load(),thread_count*per_thread);
+  EXPECT_EQ(avl_forest_range_scan(&forest,0,100000,collect_forest,&values),AVL_SUCCESS);
+  ASSERT_EQ(values.size(),static_cast<size_t>(thread_count*per_thread));
+  for (size_t index = 0; index < values.size(); index++){
+    EXPECT_EQ(values[index],static_cast<float>(index));
+  }
+  avl_forest_free(&forest);
+}
+
+// Empty forests and missing values report the same codes as the pointer
+// tree, and a fully skewed 2-shard forest rebalances.
+TEST(Forest_test,negative){
+  struct avl_forest forest;
+  float found_value=0;
+
+  EXPECT_EQ(avl_forest_init(&forest,0,0,10),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_init(&forest,2,10,10),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_init(&forest,2,0,10),AVL_SUCCESS);
+  EXPECT_EQ(avl_forest_search(1,&forest),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_forest_remove(1,&forest),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_forest_min_get(&forest,&found_value),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_forest_max_get(&forest,&found_value),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_forest_range_scan(&forest,5,1,collect_forest,nullptr),AVL_INVALID_PARAM);
+
+  // NaN is rejected instead of being routed to a shard.
+  EXPECT_EQ(avl_forest_add(nanf(""),&forest),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_remove(nanf(""),&forest),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_search(nanf(""),&forest),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_range_scan(&forest,nanf(""),1,collect_forest,nullptr),
+            AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_forest_range_scan(&forest,0,nanf(""),collect_forest,nullptr),
+            AVL_INVALID_PARAM);
+  EXPECT_EQ(forest.size.load(),0);
+
+  // Values outside the initial interval go to the edge shards.
+  EXPECT_EQ(avl_forest_add(-50,&forest),AVL_SUCCESS);
+  EXPECT_EQ(avl_forest_add(50,&forest),AVL_SUCCESS);
+  EXPECT_EQ(avl_forest_search(2,&forest),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_forest_remove(2,&forest),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_forest_min_get(&forest,&found_value),AVL_SUCCESS);
+  EXPECT_EQ(found_value,-50);
+  EXPECT_EQ(avl_forest_max_get(&forest,&found_value),AVL_SUCCESS);
+  EXPECT_EQ(found_value,50);
+  avl_forest_free(&forest);
+
+  // Two shards, every value in the first one: the bounds still move.
+  EXPECT_EQ(avl_forest_init(&forest,2,0,100),AVL_SUCCESS);
+  for (int index = 0; index < 2*AVL_FOREST_MIN_REBALANCE; index++){
+    EXPECT_EQ(avl_forest_add(static_cast<float>(index)/1000,&forest),AVL_SUCCESS);
+  }
+  EXPECT_LT(forest.shards[1].low.load(),50);
+  EXPECT_GT(forest.shards[1].size.load(),0);
+  EXPECT_LE(forest.shards[0].size.load(),
+            static_cast<int>(AVL_FOREST_MAX_SHARE*forest.size.load())+1);
+  avl_forest_free(&forest);
+}
@@ -0,0 +1,128 @@
+#include "AVL_frozen.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+// Lower bounds, lookups and batches agree with std::set, and a frozen
+// search costs less than a search on the live tree.
+TEST(Frozen_test,positive){
+  struct avl_node *root=nullptr;
+  struct avl_frozen_tree frozen;
+  set<float> reference;
+  uint32_t found_index;
+
+  srand(23);
+  for (int index = 0; index < 100000; index++){
+    float value=static_cast<float>(rand()%400000)/2;
+    avl_node_add(value,&root);
+    reference.insert(value);
+  }
+  ASSERT_EQ(avl_freeze(root,&frozen),AVL_SUCCESS);
+  EXPECT_EQ(frozen.count,reference.size());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(frozen.keys)%64,0u);
+
+  vector<float> queries;
+  for (int index = 0; index < 20003; index++){
+    queries.push_back(static_cast<float>(rand()%410000)/2-1000);
+  }
+  vector<uint32_t> indices(queries.size());
+  EXPECT_EQ(avl_frozen_lower_bound_batch(queries.data(),queries.size(),&frozen,
+                                         indices.data()),AVL_SUCCESS);
+  for (size_t index = 0; index < queries.size(); index++){
+    set<float>::iterator bound=reference.lower_bound(queries[index]);
+    int status=avl_frozen_lower_bound(queries[index],&frozen,&found_index);
+    if (bound==reference.end()){
+      EXPECT_EQ(status,AVL_OUT_OF_RANGE);
+      EXPECT_EQ(indices[index],0u);
+      continue;
+    }
+    ASSERT_EQ(status,AVL_SUCCESS);
+    EXPECT_EQ(frozen.keys[found_index],*bound);
+    EXPECT_EQ(indices[index],found_index);
+    EXPECT_EQ(avl_frozen_search(queries[index],&frozen,&found_index)==AVL_SUCCESS,
+              *bound==queries[index]);
+  }
+
+  // Same hits, timed on both layouts.
+  struct avl_node *found_node;
+  int live_hits=0;
+  int frozen_hits=0;
+  chrono::steady_clock::time_point start=chrono::steady_clock::now();
+  for (int round = 0; round < 10; round++){
+    for (size_t index = 0; index < queries.size(); index++){
+      live_hits+=avl_search(queries[index],&root,&found_node)==AVL_SUCCESS;
+    }
+  }
+  chrono::steady_clock::time_point middle=chrono::steady_clock::now();
+  for (int round = 0; round < 10; round++){
+    for (size_t index = 0; index < queries.size(); index++){
+      frozen_hits+=avl_frozen_search(queries[index],&frozen,&found_index)==AVL_SUCCESS;
+    }
+  }
+  chrono::steady_clock::time_point end=chrono::steady_clock::now();
+  EXPECT_EQ(live_hits,frozen_hits);
+  RecordProperty("live_search_ns",static_cast<int>(
+    chrono::duration_cast<chrono::nanoseconds>(middle-start).count()/(10*queries.size())));
+  RecordProperty("frozen_search_ns",static_cast<int>(
+    chrono::duration_cast<chrono::nanoseconds>(end-middle).count()/(10*queries.size())));
+
+  avl_frozen_free(&frozen);
+  free_tree_mem(root);
+}
+
+// Every size up to a few levels keeps the in-order fill consistent.
+TEST(Frozen_test,small_sizes){
+  for (int size = 1; size < 70; size++){
+    struct avl_node *root=nullptr;
+    struct avl_frozen_tree frozen;
+    uint32_t found_index;
+    for (int value = 0; value < size; value++){
+      avl_node_add(static_cast<float>(2*value),&root);
+    }
+    ASSERT_EQ(avl_freeze(root,&frozen),AVL_SUCCESS);
+    for (int value = 0; value < size; value++){
+      EXPECT_EQ(avl_frozen_search(static_cast<float>(2*value),&frozen,&found_index),AVL_SUCCESS);
+      EXPECT_EQ(avl_frozen_lower_bound(static_cast<float>(2*value-1),&frozen,&found_index),
+                AVL_SUCCESS);
+      EXPECT_EQ(frozen.keys[found_index],static_cast<float>(2*value));
+    }
+    EXPECT_EQ(avl_frozen_lower_bound(static_cast<float>(2*size),&frozen,&found_index),
+              AVL_OUT_OF_RANGE);
+    avl_frozen_free(&frozen);
+    free_tree_mem(root);
+  }
+}
+
+// Empty trees, missing values and bad batches are reported.
+TEST(Frozen_test,negative){
+  struct avl_frozen_tree frozen;
+  struct avl_node *root=nullptr;
+  uint32_t found_index;
+  uint32_t indices[2];
+  float nums[2]={1,2};
+
+  ASSERT_EQ(avl_freeze(nullptr,&frozen),AVL_SUCCESS);
+  EXPECT_EQ(avl_frozen_search(1,&frozen,&found_index),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_frozen_lower_bound(1,&frozen,&found_index),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_frozen_lower_bound_batch(nums,2,&frozen,indices),AVL_SUCCESS);
+  EXPECT_EQ(indices[0],0u);
+  avl_frozen_free(&frozen);
+
+  avl_node_add(5,&root);
+  ASSERT_EQ(avl_freeze(root,&frozen),AVL_SUCCESS);
+  EXPECT_EQ(avl_frozen_search(4,&frozen,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_frozen_lower_bound(6,&frozen,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_frozen_lower_bound_batch(nums,-1,&frozen,indices),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_frozen_lower_bound_batch(nullptr,2,&frozen,indices),AVL_INVALID_PARAM);
+  avl_frozen_free(&frozen);
+  free_tree_mem(root);
+
+  // Only the size of the root is read before the limit check.
+  struct avl_node huge={};
+  huge.size=AVL_FROZEN_MAX_KEYS+1;
+  EXPECT_EQ(avl_freeze(&huge,&frozen),AVL_OUT_OF_RANGE);
+}
@@ -0,0 +1,166 @@
+#include "AVL_generic.hpp"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+
+using namespace std;
+
+// Recomputes subtree heights of a generic tree and checks the AVL condition.
+// Returns the real height or -1 on mismatch.
+template<class Node>
+static int check_generic(const Node *node){
+    if (node==nullptr){
+        return 0;
+    }
+    int left_height=check_generic(node->lc_node);
+    int right_height=check_generic(node->rc_node);
+    int balance=left_height-right_height;
+    if (left_height<0 || right_height<0 || balance>1 || balance<-1){
+        return -1;
+    }
+    int height=max(left_height,right_height)+1;
+    return (height==node->height) ? height : -1;
+}
+
+// 64-bit integer IDs with a string payload, compared against std::set.
+TEST(Generic_tree_test,positive){
+  avl_tree<int64_t,string> tree;
+  set<int64_t> reference;
+  avl_tree<int64_t,string>::node_type *found_node=nullptr;
+
+  srand(11);
+  for (int index = 0; index < 4000; index++){
+    int64_t key=(static_cast<int64_t>(rand()%2000) << 33) + 5;
+    if (rand()%4==0){
+      int status=tree.erase(key);
+      EXPECT_EQ(status==AVL_SUCCESS,reference.erase(key)==1);
+    }
+    else {
+      EXPECT_EQ(tree.insert(key,to_string(key)),AVL_SUCCESS);
+      reference.insert(key);
+    }
+  }
+  EXPECT_GE(check_generic(tree.root()),0);
+  EXPECT_EQ(tree.size(),reference.size());
+
+  // Payloads follow their keys through rotations and removals, and order
+  // statistics match the position in the reference.
+  int position=0;
+  for (set<int64_t>::iterator it = reference.begin(); it != reference.end(); ++it){
+    ASSERT_NE(tree.find(*it),nullptr);
+    EXPECT_EQ(*tree.find(*it),to_string(*it));
+    EXPECT_EQ(tree.rank(*it),position);
+    EXPECT_EQ(tree.select(position,&found_node),AVL_SUCCESS);
+    EXPECT_EQ(found_node->key,*it);
+    position++;
+  }
+  EXPECT_EQ(tree.select(position,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(tree.min_get(&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->key,*reference.begin());
+  EXPECT_EQ(tree.max_get(&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->key,*reference.rbegin());
+}
+
+// Move-only payloads go through insert and emplace without copies.
+TEST(Generic_tree_test,move_aware){
+  avl_tree<double,unique_ptr<int> > tree;
+
+  EXPECT_EQ(tree.insert(1.5,unique_ptr<int>(new int(15))),AVL_SUCCESS);
+  EXPECT_EQ(tree.emplace(2.5,new int(25)),AVL_SUCCESS);
+
+  // A repeated key keeps the original payload.
+  unique_ptr<int> other(new int(99));
+  EXPECT_EQ(tree.insert(1.5,std::move(other)),AVL_SUCCESS);
+  EXPECT_EQ(tree.size(),2u);
+  EXPECT_EQ(**tree.find(1.5),15);
+  EXPECT_EQ(**tree.find(2.5),25);
+}
+
+// Fixed-size string keys with a custom comparator.
+TEST(Generic_tree_test,fixed_string){
+  typedef avl_fixed_string<8> name;
+  avl_tree<name,int,greater<name> > tree;
+  avl_tree<name,int,greater<name> >::node_type *found_node=nullptr;
+
+  EXPECT_EQ(tree.emplace("delta",4),AVL_SUCCESS);
+  EXPECT_EQ(tree.emplace("alpha",1),AVL_SUCCESS);
+  EXPECT_EQ(tree.emplace("charlie",3),AVL_SUCCESS);
+  EXPECT_EQ(tree.emplace("bravo",2),AVL_SUCCESS);
+
+  // Reverse order: the first node holds the greatest key.
+  EXPECT_EQ(tree.min_get(&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,4);
+  EXPECT_EQ(tree.search(name("charlie"),&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,3);
+}
+
+// Bound queries and range scans on integer keys.
+TEST(Generic_tree_test,range){
+  avl_tree<int64_t,int> tree;
+  avl_tree<int64_t,int>::node_type *found_node=nullptr;
+
+  for (int64_t key = 0; key < 100; key+=5){
+    EXPECT_EQ(tree.insert(key,static_cast<int>(key)),AVL_SUCCESS);
+  }
+  EXPECT_EQ(tree.lower_bound(12,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->key,15);
+  EXPECT_EQ(tree.upper_bound(15,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->key,20);
+  EXPECT_EQ(tree.floor(12,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->key,10);
+  EXPECT_EQ(tree.upper_bound(95,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(tree.range_count(10,30),4);
+
+  // Scans stop early when the visitor asks for it.
+  int64_t sum=0;
+  int status=tree.range_scan(10,30,[&sum](avl_tree<int64_t,int>::node_type *node){
+    sum+=node->key;
+    return (node->key < 20) ? AVL_SUCCESS : AVL_TIMEOUT;
+  });
+  EXPECT_EQ(status,AVL_TIMEOUT);
+  EXPECT_EQ(sum,10+15+20);
+}
+
+// Iterators walk the keys in both directions.
+TEST(Generic_tree_test,iterator){
+  avl_tree<int,int> tree;
+  for (int key = 20; key > 0; key--){
+    tree.insert(key,key*key);
+  }
+  tree.erase(7);
+
+  int expected=1;
+  for (avl_tree<int,int>::iterator it = tree.begin(); it != tree.end(); ++it){
+    expected+=(expected==7) ? 1 : 0;
+    EXPECT_EQ(it->key,expected);
+    EXPECT_EQ(it->value,expected*expected);
+    expected++;
+  }
+  EXPECT_EQ(expected,21);
+
+  expected=20;
+  for (avl_tree<int,int>::reverse_iterator it = tree.rbegin(); it != tree.rend(); ++it){
+    expected-=(expected==7) ? 1 : 0;
+    EXPECT_EQ(it->key,expected);
+    expected--;
+  }
+  EXPECT_EQ(expected,0);
+}
+
+// Empty trees and missing keys report the same codes as the float API.
+TEST(Generic_tree_test,negative){
+  avl_tree<int64_t,int> tree;
+  avl_tree<int64_t,int>::node_type *found_node=nullptr;
+
+  EXPECT_EQ(tree.erase(1),AVL_NOT_FOUND);
+  EXPECT_EQ(tree.search(1,&found_node),AVL_NOT_FOUND);
+  EXPECT_EQ(tree.min_get(&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(tree.max_get(&found_node),AVL_OUT_OF_RANGE);
+
+  EXPECT_EQ(tree.insert(1,1),AVL_SUCCESS);
+  EXPECT_EQ(tree.erase(2),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(tree.search(0,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(tree.find(0),nullptr);
+}
@@ -0,0 +1,157 @@
+#include "AVL_lazy.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+// Height of a valid subtree with consistent sizes and totals, or -1.
+static int check_lazy(
+  struct avl_node *node){
+    if (node==nullptr){
+      return 0;
+    }
+    int left=check_lazy(node->lc_node);
+    int right=check_lazy(node->rc_node);
+    if (left<0 || right<0 || abs(left-right)>1 ||
+        node->height!=max(left,right)+1 ||
+        node->size!=1+get_size(node->lc_node)+get_size(node->rc_node) ||
+        node->total!=node->count+avl_multi_size(node->lc_node)+
+                     avl_multi_size(node->rc_node)){
+      return -1;
+    }
+    return node->height;
+}
+
+static int collect_lazy(
+  struct avl_node *node,
+  void            *context){
+    static_cast<vector<float> *>(context)->push_back(node->value);
+    return AVL_SUCCESS;
+}
+
+// Mixed adds and removes agree with std::set, removes leave the shape
+// alone, and adds keep tombstones under the ratio.
+TEST(Lazy_test,positive){
+  struct avl_lazy_tree tree;
+  set<float> reference;
+  ASSERT_EQ(avl_lazy_init(&tree,0.25f),AVL_SUCCESS);
+
+  for (int index = 0; index < 1000; index++){
+    ASSERT_EQ(avl_lazy_add(static_cast<float>(index),&tree),AVL_SUCCESS);
+    reference.insert(static_cast<float>(index));
+  }
+
+  // Removing only marks nodes.
+  struct avl_node *old_root=tree.root;
+  int old_height=tree.root->height;
+  for (int index = 0; index < 250; index++){
+    ASSERT_EQ(avl_lazy_remove(static_cast<float>(index*4),&tree),AVL_SUCCESS);
+    reference.erase(static_cast<float>(index*4));
+  }
+  EXPECT_EQ(tree.root,old_root);
+  EXPECT_EQ(tree.root->height,old_height);
+  EXPECT_EQ(tree.root->size,1000);
+  EXPECT_EQ(tree.tombstones,250);
+  EXPECT_EQ(avl_lazy_size(&tree),750);
+
+  // Removed values are skipped, and come back on their old nodes.
+  struct avl_node *found_node;
+  float value;
+  EXPECT_EQ(avl_lazy_search(0,&tree,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_min_get(&tree,&value),AVL_SUCCESS);
+  EXPECT_EQ(value,1);
+  EXPECT_EQ(avl_lazy_add(0,&tree),AVL_SUCCESS);
+  EXPECT_EQ(tree.root->size,1000);
+  EXPECT_EQ(avl_lazy_min_get(&tree,&value),AVL_SUCCESS);
+  EXPECT_EQ(value,0);
+  reference.insert(0);
+
+  // Removes never move a node, even past the ratio; adds compact once the
+  // ratio is passed.
+  srand(37);
+  for (int index = 0; index < 20000; index++){
+    float key=static_cast<float>(rand()%2000);
+    if (rand()%3==0){
+      EXPECT_EQ(avl_lazy_add(key,&tree),AVL_SUCCESS);
+      reference.insert(key);
+      ASSERT_LE(tree.tombstones,0.25f*tree.root->size);
+    }
+    else if (tree.root!=nullptr){
+      old_root=tree.root;
+      old_height=tree.root->height;
+      int old_size=tree.root->size;
+      EXPECT_EQ(avl_lazy_remove(key,&tree)==AVL_SUCCESS,reference.erase(key)==1);
+      ASSERT_EQ(tree.root,old_root);
+      ASSERT_EQ(tree.root->height,old_height);
+      ASSERT_EQ(tree.root->size,old_size);
+    }
+  }
+  ASSERT_GE(check_lazy(tree.root),0);
+  EXPECT_EQ(avl_lazy_size(&tree),static_cast<int>(reference.size()));
+  EXPECT_EQ(tree.root->size-tree.root->total,tree.tombstones);
+
+  vector<float> values;
+  EXPECT_EQ(avl_lazy_range_scan(&tree,-1,3000,collect_lazy,&values),AVL_SUCCESS);
+  EXPECT_TRUE(values.size()==reference.size() &&
+              equal(values.begin(),values.end(),reference.begin()));
+  EXPECT_EQ(avl_lazy_min_get(&tree,&value),AVL_SUCCESS);
+  EXPECT_EQ(value,*reference.begin());
+  EXPECT_EQ(avl_lazy_max_get(&tree,&value),AVL_SUCCESS);
+  EXPECT_EQ(value,*reference.rbegin());
+
+  // Compaction keeps the values on the same nodes.
+  EXPECT_EQ(avl_lazy_search(*reference.begin(),&tree,&found_node),AVL_SUCCESS);
+  struct avl_node *kept_node=found_node;
+  EXPECT_EQ(avl_lazy_compact(&tree),AVL_SUCCESS);
+  EXPECT_EQ(tree.tombstones,0);
+  EXPECT_EQ(tree.root->size,static_cast<int>(reference.size()));
+  ASSERT_GE(check_lazy(tree.root),0);
+  EXPECT_EQ(tree.root->parent,nullptr);
+  EXPECT_EQ(avl_lazy_search(*reference.begin(),&tree,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node,kept_node);
+  values.clear();
+  avl_lazy_range_scan(&tree,-1,3000,collect_lazy,&values);
+  EXPECT_TRUE(values.size()==reference.size() &&
+              equal(values.begin(),values.end(),reference.begin()));
+
+  avl_lazy_free(&tree);
+}
+
+// Bad ratios, empty trees and removed values are reported.
+TEST(Lazy_test,negative){
+  struct avl_lazy_tree tree;
+  struct avl_node *found_node;
+  float value;
+
+  EXPECT_EQ(avl_lazy_init(&tree,0),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_lazy_init(&tree,1.5f),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_lazy_init(nullptr,0.5f),AVL_INVALID_PARAM);
+  ASSERT_EQ(avl_lazy_init(&tree,1),AVL_SUCCESS);
+
+  EXPECT_EQ(avl_lazy_remove(1,&tree),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_lazy_search(1,&tree,&found_node),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_lazy_min_get(&tree,&value),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_range_scan(&tree,2,1,collect_lazy,nullptr),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_lazy_compact(&tree),AVL_SUCCESS);
+
+  // A tree of tombstones only has no min or max.
+  EXPECT_EQ(avl_lazy_add(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_lazy_add(2,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_lazy_remove(3,&tree),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_remove(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_lazy_remove(1,&tree),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_remove(2,&tree),AVL_SUCCESS);
+  EXPECT_EQ(tree.tombstones,2);
+  EXPECT_EQ(avl_lazy_size(&tree),0);
+  EXPECT_EQ(avl_lazy_search(2,&tree,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_min_get(&tree,&value),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_lazy_max_get(&tree,&value),AVL_OUT_OF_RANGE);
+
+  EXPECT_EQ(avl_lazy_compact(&tree),AVL_SUCCESS);
+  EXPECT_EQ(tree.root,nullptr);
+  EXPECT_EQ(avl_lazy_remove(2,&tree),AVL_NOT_FOUND);
+
+  avl_lazy_free(&tree);
+}
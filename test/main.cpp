@@ -1,9 +1,11 @@
 #include "AVL_tree.hpp"
 #include "gtest/gtest.h"
-#include <chrono>
-#include <fstream>
+#include <cmath>
 #include <cstdlib>
-#include <ctime>
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
 
 using namespace std;
 
@@ -51,73 +53,6 @@ TEST(Create_test,negative) {
     delete list;
 }
 
-TEST(Time_complex,positive){
-  int status = 0;
-  float min_order = 100;
-  float max_order = 100000;
-  int test_quantity = 100;
-  int repetition_quantity = 100;
-
-  srand (static_cast <unsigned> (time(nullptr)));
-
-  // Create the test result file
-  ofstream resultados;
-  resultados.open ("time.csv");
-  resultados << "These are the time complexity test results\n";
-  resultados << "Test N.;Nth add;Time[ns]\n";
-  resultados.close();
-
-  int Nth = 0;
-  int median_time=0;
-  float times[100];
-
-
-  for (int index = 0; index < test_quantity; index++) {
-    // Obtaining the strcture size
-    int list_size = min_order + (int)(max_order*rand()/(RAND_MAX+min_order));
-
-    median_time=0;
-    
-    // Creating the test structure
-    float *list=random_list(list_size);
-    struct avl_node *root=nullptr;
-    status=avl_create(list,list_size,&root);
-    
-    for (int idx_2 = 0; idx_2 < repetition_quantity; idx_2++){
-
-      // Adding the N-th node and measuring execution time
-      float new_node_value =static_cast <float>(rand());
-      auto start = chrono::steady_clock::now();
-      avl_node_add(new_node_value, &root);
-      auto stop = chrono::steady_clock::now();
-
-      // Saving test results (N and time)
-      auto duration = chrono::duration_cast<chrono::nanoseconds>(stop - start);
-      
-      times[idx_2]= static_cast<float>(duration.count());
-  
-    }
-    
-    //Free memory
-    free_tree_mem(root);
-    delete list;
-      
-    Nth = list_size+1;
-
-    median_time = static_cast<int>(median(times,repetition_quantity));
-    ofstream results;
-    results.open("time.csv", ios_base::app);
-    results << index << ";" << Nth << ";" << median_time << endl;
-    cout << "Time test:\t" << Nth <<"\t"<< median_time <<"\t...saved (" << index << " out of " << test_quantity << ")" << '\n';
-  
-
-  }
-
-
-    EXPECT_EQ(status, 0);
-  }
-
-
 // Positive test for getting min value of element, status should be AVL_SUCCESS
 TEST(Min_test,positive) {
     int status = AVL_SUCCESS;
@@ -455,6 +390,928 @@ TEST(Print,positive) {
 }
 
 
+// Recomputes the height of every node and checks it against the stored one
+// and the AVL balance condition. Returns the real height or -1 on mismatch.
+int check_heights(struct avl_node *node){
+    if (node==nullptr){
+        return 0;
+    }
+    int left_height=check_heights(node->lc_node);
+    int right_height=check_heights(node->rc_node);
+    if (left_height<0 || right_height<0){
+        return -1;
+    }
+    int height=max(left_height,right_height)+1;
+    int balance=left_height-right_height;
+    if (height!=node->height || balance>1 || balance<-1){
+        return -1;
+    }
+    return height;
+}
+
+// Stored heights must match the real ones after adds and removes.
+TEST(Height_test,positive){
+  int list_size=1000;
+  float *list=random_list(list_size);
+  struct avl_node *root=nullptr;
+
+  // Use distinct values so the tree gets deep.
+  for (int index = 0; index < list_size; index++){
+    list[index]=static_cast<float>(index*7919%list_size);
+  }
+  avl_create(list,list_size,&root);
+  EXPECT_GT(check_heights(root),0);
+
+  // Remove half of the values and check again.
+  for (int index = 0; index < list_size; index+=2){
+    EXPECT_EQ(avl_node_remove(list[index],&root),AVL_SUCCESS);
+  }
+  EXPECT_GT(check_heights(root),0);
+  EXPECT_EQ(get_height(root),check_heights(root));
+
+  //Free memory
+  free_tree_mem(root);
+  delete[] list;
+}
+
+
+// Bulk creation must hold the same values as incremental creation.
+TEST(Bulk_create_test,positive){
+  int list_size=500;
+  float *list=random_list(list_size);
+  struct avl_node *root=nullptr;
+  struct avl_node *bulk_root=nullptr;
+  struct avl_node *found_node=nullptr;
+
+  avl_create(list,list_size,&root);
+  EXPECT_EQ(avl_bulk_create(list,list_size,&bulk_root),AVL_SUCCESS);
+
+  // Balanced and with consistent heights.
+  EXPECT_GT(check_heights(bulk_root),0);
+  EXPECT_LE(get_height(bulk_root),get_height(root));
+
+  // Every value of the list is present.
+  for (int index = 0; index < list_size; index++){
+    EXPECT_EQ(avl_search(list[index],&bulk_root,&found_node),AVL_SUCCESS);
+  }
+
+  //Free memory
+  free_tree_mem(root);
+  free_tree_mem(bulk_root);
+  delete[] list;
+}
+
+// Bulk creation with an invalid list size returns AVL_INVALID_PARAM.
+TEST(Bulk_create_test,negative){
+  int list_size=10;
+  float *list=random_list(list_size);
+  struct avl_node *root=nullptr;
+
+  EXPECT_EQ(avl_bulk_create(list,0,&root),AVL_INVALID_PARAM);
+  EXPECT_EQ(root,nullptr);
+
+  //Free memory
+  delete[] list;
+}
+
+
+// Pool trees behave like heap trees and reuse removed nodes.
+TEST(Pool_test,positive){
+  struct avl_pool pool;
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+  int list_size=300;
+
+  // Small slabs so several of them are needed.
+  EXPECT_EQ(avl_pool_init(&pool,64),AVL_SUCCESS);
+  for (int index = 0; index < list_size; index++){
+    EXPECT_EQ(avl_pool_node_add(static_cast<float>(index),&root,&pool),AVL_SUCCESS);
+  }
+  EXPECT_EQ(pool.live_nodes,list_size);
+  EXPECT_GT(check_heights(root),0);
+
+  // A removed node is handed out again by the next add.
+  EXPECT_EQ(avl_search(10,&root,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(avl_pool_node_remove(10,&root,&pool),AVL_SUCCESS);
+  struct avl_node *freed=pool.free_list;
+  EXPECT_NE(freed,nullptr);
+  EXPECT_EQ(avl_pool_node_add(1000,&root,&pool),AVL_SUCCESS);
+  EXPECT_EQ(avl_search(1000,&root,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node,freed);
+  EXPECT_EQ(avl_search(10,&root,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_GT(check_heights(root),0);
+
+  // Drop the whole tree at once.
+  avl_pool_release(&pool);
+  EXPECT_EQ(pool.live_nodes,0);
+  EXPECT_EQ(pool.slabs,nullptr);
+}
+
+// Pools need at least one node per slab.
+TEST(Pool_test,negative){
+  struct avl_pool pool;
+  EXPECT_EQ(avl_pool_init(&pool,0),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_pool_init(nullptr,AVL_POOL_SLAB_SIZE),AVL_INVALID_PARAM);
+}
+
+
+// Long sorted runs stay within the path stack bound and empty the tree.
+TEST(Iterative_test,positive){
+  int list_size=100000;
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+
+  for (int index = 0; index < list_size; index++){
+    EXPECT_EQ(avl_node_add(static_cast<float>(index),&root),AVL_SUCCESS);
+  }
+  EXPECT_GT(check_heights(root),0);
+  EXPECT_LT(get_height(root),AVL_MAX_HEIGHT);
+
+  EXPECT_EQ(avl_min_get(root,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,0);
+  EXPECT_EQ(avl_max_get(root,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,list_size-1);
+
+  // Remove everything in reverse order.
+  for (int index = list_size-1; index >= 0; index--){
+    EXPECT_EQ(avl_node_remove(static_cast<float>(index),&root),AVL_SUCCESS);
+  }
+  EXPECT_EQ(root,nullptr);
+}
+
+
+// Recomputes subtree sizes and checks them against the stored ones.
+// Returns the real size or -1 on mismatch.
+int check_sizes(struct avl_node *node){
+    if (node==nullptr){
+        return 0;
+    }
+    int left_size=check_sizes(node->lc_node);
+    int right_size=check_sizes(node->rc_node);
+    if (left_size<0 || right_size<0 || node->size!=left_size+right_size+1){
+        return -1;
+    }
+    return node->size;
+}
+
+// Rank, select and median agree with a sorted copy of the values.
+TEST(Order_statistic_test,positive){
+  int list_size=2001;
+  float *list=new float[list_size];
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+  int rank=-1;
+  float median_value=0;
+
+  for (int index = 0; index < list_size; index++){
+    list[index]=static_cast<float>(index*7919%list_size);
+  }
+  avl_create(list,list_size,&root);
+
+  // Remove some values so sizes go through removals too.
+  for (int index = 0; index < 100; index++){
+    EXPECT_EQ(avl_node_remove(static_cast<float>(index*3),&root),AVL_SUCCESS);
+  }
+  EXPECT_EQ(check_sizes(root),list_size-100);
+
+  vector<float> sorted;
+  for (int index = 0; index < list_size; index++){
+    if (index>=300 || index%3!=0){
+      sorted.push_back(static_cast<float>(index));
+    }
+  }
+  for (int k = 0; k < static_cast<int>(sorted.size()); k++){
+    EXPECT_EQ(avl_select(root,k,&found_node),AVL_SUCCESS);
+    EXPECT_EQ(found_node->value,sorted[k]);
+    EXPECT_EQ(avl_rank(root,sorted[k],&rank),AVL_SUCCESS);
+    EXPECT_EQ(rank,k);
+  }
+
+  // Median matches the array based median.
+  EXPECT_EQ(avl_median(root,&median_value),AVL_SUCCESS);
+  EXPECT_EQ(median_value,median(sorted.data(),static_cast<int>(sorted.size())));
+  EXPECT_EQ(avl_node_remove(sorted.back(),&root),AVL_SUCCESS);
+  sorted.pop_back();
+  EXPECT_EQ(avl_median(root,&median_value),AVL_SUCCESS);
+  EXPECT_EQ(median_value,median(sorted.data(),static_cast<int>(sorted.size())));
+
+  //Free memory
+  free_tree_mem(root);
+  delete[] list;
+}
+
+// Out of range positions and empty trees are reported.
+TEST(Order_statistic_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+  float median_value=0;
+  int rank=-1;
+
+  EXPECT_EQ(avl_median(root,&median_value),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_select(root,0,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_rank(root,1,&rank),AVL_SUCCESS);
+  EXPECT_EQ(rank,0);
+
+  avl_node_add(1,&root);
+  EXPECT_EQ(avl_select(root,1,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_select(root,-1,&found_node),AVL_OUT_OF_RANGE);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+
+// Collects visited values in a vector given as context.
+int collect_values(struct avl_node *node, void *context){
+    static_cast<vector<float> *>(context)->push_back(node->value);
+    return AVL_SUCCESS;
+}
+
+// Bound queries and range scans agree with a sorted list of the values.
+TEST(Range_test,positive){
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+  int count=-1;
+
+  // Even values from 0 to 198.
+  for (int index = 0; index < 100; index++){
+    avl_node_add(static_cast<float>(2*index),&root);
+  }
+
+  EXPECT_EQ(avl_lower_bound(root,41,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,42);
+  EXPECT_EQ(avl_lower_bound(root,42,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,42);
+  EXPECT_EQ(avl_upper_bound(root,42,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,44);
+  EXPECT_EQ(avl_floor(root,41,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,40);
+  EXPECT_EQ(avl_ceiling(root,-5,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,0);
+
+  // [10, 20) holds 10, 12, 14, 16 and 18.
+  EXPECT_EQ(avl_range_count(root,10,20,&count),AVL_SUCCESS);
+  EXPECT_EQ(count,5);
+  vector<float> values;
+  EXPECT_EQ(avl_range_scan(root,9,20,collect_values,&values),AVL_SUCCESS);
+  vector<float> expected={10,12,14,16,18};
+  EXPECT_EQ(values,expected);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Bounds outside the values, empty trees and reversed ranges are reported.
+TEST(Range_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node=nullptr;
+  vector<float> values;
+  int count=-1;
+
+  EXPECT_EQ(avl_lower_bound(root,1,&found_node),AVL_NOT_FOUND);
+  avl_node_add(1,&root);
+  avl_node_add(2,&root);
+  EXPECT_EQ(avl_lower_bound(root,3,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_upper_bound(root,2,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_floor(root,0,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_range_count(root,2,1,&count),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_range_scan(root,0,3,nullptr,&values),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_range_scan(root,5,9,collect_values,&values),AVL_SUCCESS);
+  EXPECT_TRUE(values.empty());
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+
+// Checks that every child points back to its parent.
+bool check_parents(struct avl_node *node, struct avl_node *parent){
+    if (node==nullptr){
+        return true;
+    }
+    return node->parent==parent &&
+           check_parents(node->lc_node,node) &&
+           check_parents(node->rc_node,node);
+}
+
+// Forward and reverse walks visit every value in order, and a cursor stays
+// valid while other values are added and removed.
+TEST(Iterator_test,positive){
+  int list_size=1000;
+  struct avl_node *root=nullptr;
+  struct avl_node *node=nullptr;
+  struct avl_node *cursor=nullptr;
+
+  for (int index = 0; index < list_size; index++){
+    avl_node_add(static_cast<float>(index*7919%list_size),&root);
+  }
+  for (int index = 0; index < list_size; index+=4){
+    avl_node_remove(static_cast<float>(index),&root);
+  }
+  EXPECT_TRUE(check_parents(root,nullptr));
+
+  // Forward walk.
+  vector<float> forward;
+  int status=avl_min_get(root,&node);
+  while (status==AVL_SUCCESS){
+    forward.push_back(node->value);
+    status=avl_next(node,&node);
+  }
+  EXPECT_EQ(status,AVL_OUT_OF_RANGE);
+  EXPECT_EQ(static_cast<int>(forward.size()),get_size(root));
+  EXPECT_TRUE(is_sorted(forward.begin(),forward.end()));
+
+  // Reverse walk.
+  vector<float> reverse;
+  status=avl_max_get(root,&node);
+  while (status==AVL_SUCCESS){
+    reverse.push_back(node->value);
+    status=avl_prev(node,&node);
+  }
+  EXPECT_TRUE(equal(forward.begin(),forward.end(),reverse.rbegin()));
+
+  // Keep a cursor on 501 while the rest of the tree changes.
+  EXPECT_EQ(avl_search(501,&root,&cursor),AVL_SUCCESS);
+  for (int index = 0; index < list_size; index+=4){
+    avl_node_add(static_cast<float>(index),&root);
+  }
+  for (int index = 1; index < 500; index+=2){
+    avl_node_remove(static_cast<float>(index),&root);
+  }
+  EXPECT_TRUE(check_parents(root,nullptr));
+  EXPECT_EQ(cursor->value,501);
+  EXPECT_EQ(avl_next(cursor,&node),AVL_SUCCESS);
+  EXPECT_EQ(node->value,502);
+  EXPECT_EQ(avl_prev(cursor,&node),AVL_SUCCESS);
+  EXPECT_EQ(node->value,500);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Walking past either end is reported.
+TEST(Iterator_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_node *node=nullptr;
+
+  EXPECT_EQ(avl_next(nullptr,&node),AVL_INVALID_PARAM);
+  avl_node_add(1,&root);
+  EXPECT_EQ(avl_next(root,&node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_prev(root,&node),AVL_OUT_OF_RANGE);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+
+// Batches give the same contents as one by one updates and keep the tree
+// balanced with consistent sizes and parents.
+TEST(Batch_test,positive){
+  struct avl_node *root=nullptr;
+  set<float> reference;
+
+  // Several rounds of overlapping batches.
+  srand(5);
+  for (int round = 0; round < 20; round++){
+    vector<float> batch;
+    int batch_size=1+rand()%2000;
+    for (int index = 0; index < batch_size; index++){
+      batch.push_back(static_cast<float>(rand()%5000));
+    }
+    if (round%3==2 && root!=nullptr){
+      // Remove only present values so the batch succeeds.
+      vector<float> present;
+      for (size_t index = 0; index < batch.size(); index++){
+        if (reference.erase(batch[index])==1){
+          present.push_back(batch[index]);
+        }
+      }
+      if (!present.empty()){
+        EXPECT_EQ(avl_remove_batch(present.data(),static_cast<int>(present.size()),&root),
+                  AVL_SUCCESS);
+      }
+    }
+    else {
+      EXPECT_EQ(avl_insert_batch(batch.data(),batch_size,&root),AVL_SUCCESS);
+      reference.insert(batch.begin(),batch.end());
+    }
+    ASSERT_GT(check_heights(root),0);
+    ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+    ASSERT_TRUE(check_parents(root,nullptr));
+  }
+
+  // Same values in the same order.
+  vector<float> values;
+  avl_range_scan(root,-1,10000,collect_values,&values);
+  EXPECT_TRUE(equal(values.begin(),values.end(),reference.begin()));
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Invalid batches and missing values are reported.
+TEST(Batch_test,negative){
+  struct avl_node *root=nullptr;
+  float batch[3]={1,2,3};
+  float missing[2]={3,4};
+
+  EXPECT_EQ(avl_insert_batch(batch,0,&root),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_remove_batch(batch,3,&root),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_insert_batch(batch,3,&root),AVL_SUCCESS);
+
+  // 3 is removed even though 4 is missing.
+  EXPECT_EQ(avl_remove_batch(missing,2,&root),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(get_size(root),2);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+
+// Builds a heap tree and a reference set from count random values.
+struct avl_node *random_tree(int count, int range, set<float> &reference){
+    struct avl_node *root=nullptr;
+    vector<float> values;
+    for (int index = 0; index < count; index++){
+        values.push_back(static_cast<float>(rand()%range));
+    }
+    avl_insert_batch(values.data(),count,&root);
+    reference.insert(values.begin(),values.end());
+    return root;
+}
+
+// Union, intersection and difference match std::set algorithms, both
+// sequentially and with several threads.
+TEST(Set_operation_test,positive){
+  srand(3);
+  for (int thread_count = 1; thread_count <= 4; thread_count*=4){
+    for (int round = 0; round < 3; round++){
+      int first_size=(round==0) ? 50 : 20000;
+      set<float> first_set, second_set;
+      set<float> union_set, intersection_set, difference_set;
+      vector<float> values;
+      struct avl_node *result=nullptr;
+
+      // Union.
+      struct avl_node *first=random_tree(first_size,60000,first_set);
+      struct avl_node *second=random_tree(20000,60000,second_set);
+      set_union(first_set.begin(),first_set.end(),second_set.begin(),
+                second_set.end(),inserter(union_set,union_set.end()));
+      EXPECT_EQ(avl_union(first,second,&result,thread_count),AVL_SUCCESS);
+      ASSERT_GT(check_heights(result),0);
+      ASSERT_EQ(check_sizes(result),static_cast<int>(union_set.size()));
+      ASSERT_TRUE(check_parents(result,nullptr));
+      avl_range_scan(result,-1,100000,collect_values,&values);
+      EXPECT_TRUE(equal(values.begin(),values.end(),union_set.begin()));
+      free_tree_mem(result);
+
+      // Intersection.
+      first_set.clear();
+      second_set.clear();
+      first=random_tree(first_size,60000,first_set);
+      second=random_tree(20000,60000,second_set);
+      set_intersection(first_set.begin(),first_set.end(),second_set.begin(),
+                       second_set.end(),
+                       inserter(intersection_set,intersection_set.end()));
+      EXPECT_EQ(avl_intersection(first,second,&result,thread_count),AVL_SUCCESS);
+      ASSERT_EQ(check_sizes(result),static_cast<int>(intersection_set.size()));
+      ASSERT_GE(check_heights(result),0);
+      ASSERT_TRUE(check_parents(result,nullptr));
+      values.clear();
+      avl_range_scan(result,-1,100000,collect_values,&values);
+      EXPECT_TRUE(equal(values.begin(),values.end(),intersection_set.begin()));
+      free_tree_mem(result);
+
+      // Difference.
+      first_set.clear();
+      second_set.clear();
+      first=random_tree(first_size,60000,first_set);
+      second=random_tree(20000,60000,second_set);
+      set_difference(first_set.begin(),first_set.end(),second_set.begin(),
+                     second_set.end(),inserter(difference_set,difference_set.end()));
+      EXPECT_EQ(avl_difference(first,second,&result,thread_count),AVL_SUCCESS);
+      ASSERT_EQ(check_sizes(result),static_cast<int>(difference_set.size()));
+      ASSERT_GE(check_heights(result),0);
+      ASSERT_TRUE(check_parents(result,nullptr));
+      values.clear();
+      avl_range_scan(result,-1,100000,collect_values,&values);
+      EXPECT_TRUE(equal(values.begin(),values.end(),difference_set.begin()));
+      free_tree_mem(result);
+    }
+  }
+}
+
+// Set operations need at least one thread.
+TEST(Set_operation_test,negative){
+  struct avl_node *result=nullptr;
+  EXPECT_EQ(avl_union(nullptr,nullptr,&result,0),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_intersection(nullptr,nullptr,&result,0),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_difference(nullptr,nullptr,&result,0),AVL_INVALID_PARAM);
+
+  // Empty inputs give empty results.
+  EXPECT_EQ(avl_union(nullptr,nullptr,&result,1),AVL_SUCCESS);
+  EXPECT_EQ(result,nullptr);
+}
+
+
+// Parallel creation gives the same values as bulk creation.
+TEST(Parallel_create_test,positive){
+  int list_size=200000;
+  float *list=new float[list_size];
+  struct avl_node *root=nullptr;
+  set<float> reference;
+
+  srand(9);
+  for (int index = 0; index < list_size; index++){
+    list[index]=static_cast<float>(rand()%150000);
+    reference.insert(list[index]);
+  }
+  EXPECT_EQ(avl_parallel_create(list,list_size,&root,4),AVL_SUCCESS);
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+  ASSERT_TRUE(check_parents(root,nullptr));
+
+  vector<float> values;
+  avl_range_scan(root,-1,200000,collect_values,&values);
+  EXPECT_TRUE(equal(values.begin(),values.end(),reference.begin()));
+
+  //Free memory
+  free_tree_mem(root);
+  delete[] list;
+}
+
+// Parallel creation needs a list, a thread and an empty tree.
+TEST(Parallel_create_test,negative){
+  float list[3]={1,2,3};
+  struct avl_node *root=nullptr;
+
+  EXPECT_EQ(avl_parallel_create(list,0,&root,2),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_parallel_create(list,3,&root,0),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_parallel_create(list,3,&root,2),AVL_SUCCESS);
+  EXPECT_EQ(avl_parallel_create(list,3,&root,2),AVL_INVALID_PARAM);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+
+// Recomputes repetition totals; returns the real total or -1 on mismatch.
+int check_totals(struct avl_node *node){
+    if (node==nullptr){
+        return 0;
+    }
+    int left_total=check_totals(node->lc_node);
+    int right_total=check_totals(node->rc_node);
+    if (left_total<0 || right_total<0 || node->count<1 ||
+        node->total!=left_total+right_total+node->count){
+        return -1;
+    }
+    return node->total;
+}
+
+// Repetitions are counted in place and order statistics see all of them.
+TEST(Multiset_test,positive){
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node;
+  multiset<float> reference;
+  int count=0;
+
+  srand(29);
+  for (int index = 0; index < 20000; index++){
+    float value=static_cast<float>(rand()%MAX_RAND_VALUE);
+    if (rand()%3==0){
+      int status=avl_multi_remove(value,&root);
+      multiset<float>::iterator it=reference.find(value);
+      EXPECT_EQ(status==AVL_SUCCESS,it!=reference.end());
+      if (it!=reference.end()){
+        reference.erase(it);
+      }
+    }
+    else {
+      EXPECT_EQ(avl_multi_add(value,&root),AVL_SUCCESS);
+      reference.insert(value);
+    }
+  }
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_totals(root),static_cast<int>(reference.size()));
+  EXPECT_EQ(avl_multi_size(root),static_cast<int>(reference.size()));
+
+  for (int value = -1; value <= MAX_RAND_VALUE; value++){
+    int rank=0;
+    EXPECT_EQ(avl_multi_count(root,static_cast<float>(value),&count),AVL_SUCCESS);
+    EXPECT_EQ(count,static_cast<int>(reference.count(static_cast<float>(value))));
+    EXPECT_EQ(avl_multi_rank(root,static_cast<float>(value),&rank),AVL_SUCCESS);
+    EXPECT_EQ(rank,static_cast<int>(distance(reference.begin(),
+                                             reference.lower_bound(static_cast<float>(value)))));
+  }
+  int k=0;
+  for (multiset<float>::iterator it = reference.begin(); it != reference.end(); ++it, k++){
+    ASSERT_EQ(avl_multi_select(root,k,&found_node),AVL_SUCCESS);
+    EXPECT_EQ(found_node->value,*it);
+  }
+
+  // A repeated value changes no node: same shape and same address.
+  struct avl_node *old_root=root;
+  int old_size=get_size(root);
+  float value=root->value;
+  EXPECT_EQ(avl_multi_add(value,&root),AVL_SUCCESS);
+  EXPECT_EQ(avl_multi_remove(value,&root),AVL_SUCCESS);
+  EXPECT_EQ(root,old_root);
+  EXPECT_EQ(get_size(root),old_size);
+
+  // Set functions keep one repetition per node.
+  EXPECT_EQ(avl_node_remove(value,&root),AVL_SUCCESS);
+  EXPECT_EQ(check_totals(root),static_cast<int>(reference.size()-reference.count(value)));
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Missing values and positions are reported.
+TEST(Multiset_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node;
+  int count=0;
+
+  EXPECT_EQ(avl_multi_remove(1,&root),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_multi_size(root),0);
+  EXPECT_EQ(avl_multi_select(root,0,&found_node),AVL_OUT_OF_RANGE);
+
+  EXPECT_EQ(avl_multi_add(1,&root),AVL_SUCCESS);
+  EXPECT_EQ(avl_multi_add(1,&root),AVL_SUCCESS);
+  EXPECT_EQ(avl_multi_remove(2,&root),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_multi_select(root,2,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_multi_select(root,-1,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_multi_count(root,2,&count),AVL_SUCCESS);
+  EXPECT_EQ(count,0);
+
+  // The last repetition removes the node.
+  EXPECT_EQ(avl_multi_remove(1,&root),AVL_SUCCESS);
+  EXPECT_EQ(avl_multi_remove(1,&root),AVL_SUCCESS);
+  EXPECT_EQ(root,nullptr);
+  EXPECT_EQ(avl_multi_remove(1,&root),AVL_NOT_FOUND);
+}
+
+
+// Hinted updates on sorted, nearly sorted and random streams keep a valid
+// tree with the same values as std::set.
+TEST(Hint_test,positive){
+  struct avl_node *root=nullptr;
+  struct avl_node *hint=nullptr;
+  set<float> reference;
+
+  // Sorted appends always pass the last inserted node.
+  for (int index = 0; index < 5000; index++){
+    EXPECT_EQ(avl_hint_add(static_cast<float>(index),&root,&hint),AVL_SUCCESS);
+    EXPECT_EQ(hint->value,static_cast<float>(index));
+    reference.insert(static_cast<float>(index));
+  }
+
+  // Nearly sorted values and random values with a stale hint.
+  srand(31);
+  for (int index = 0; index < 5000; index++){
+    float value=static_cast<float>(5000+index+rand()%16-8)+0.5f;
+    EXPECT_EQ(avl_hint_add(value,&root,&hint),AVL_SUCCESS);
+    reference.insert(value);
+    value=static_cast<float>(rand()%20000)+0.25f;
+    EXPECT_EQ(avl_hint_add(value,&root,&hint),AVL_SUCCESS);
+    reference.insert(value);
+  }
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+  ASSERT_EQ(check_totals(root),static_cast<int>(reference.size()));
+  ASSERT_TRUE(check_parents(root,nullptr));
+
+  // Removals walk from the returned neighbour.
+  hint=nullptr;
+  for (int index = 0; index < 10000; index++){
+    float value=(index%2==0) ? static_cast<float>(index/2) :
+                               static_cast<float>(rand()%20000)+0.25f;
+    int status=avl_hint_remove(value,&root,&hint);
+    EXPECT_EQ(status==AVL_SUCCESS,reference.erase(value)==1);
+  }
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+  ASSERT_TRUE(check_parents(root,nullptr));
+
+  vector<float> values;
+  avl_range_scan(root,-1,30000,collect_values,&values);
+  EXPECT_TRUE(equal(values.begin(),values.end(),reference.begin()));
+  EXPECT_EQ(values.size(),reference.size());
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Missing values are reported and the last removal clears the hint.
+TEST(Hint_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_node *hint=nullptr;
+
+  EXPECT_EQ(avl_hint_remove(1,&root,&hint),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_hint_add(1,&root,&hint),AVL_SUCCESS);
+  EXPECT_EQ(avl_hint_add(2,&root,&hint),AVL_SUCCESS);
+  EXPECT_EQ(avl_hint_remove(3,&root,&hint),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(hint->value,2);
+
+  // Repeated values keep the existing node.
+  struct avl_node *old_hint=hint;
+  EXPECT_EQ(avl_hint_add(2,&root,&hint),AVL_SUCCESS);
+  EXPECT_EQ(hint,old_hint);
+  EXPECT_EQ(get_size(root),2);
+
+  EXPECT_EQ(avl_hint_remove(2,&root,&hint),AVL_SUCCESS);
+  EXPECT_EQ(hint->value,1);
+  EXPECT_EQ(avl_hint_remove(1,&root,&hint),AVL_SUCCESS);
+  EXPECT_EQ(hint,nullptr);
+  EXPECT_EQ(root,nullptr);
+}
+
+
+// Split halves and joined trees stay valid and keep every value.
+TEST(Split_join_test,positive){
+  struct avl_node *root=nullptr;
+  struct avl_node *left=nullptr;
+  struct avl_node *right=nullptr;
+  struct avl_node *found_node;
+  set<float> reference;
+
+  srand(41);
+  for (int index = 0; index < 3000; index++){
+    float value=static_cast<float>(rand()%6000);
+    avl_node_add(value,&root);
+    reference.insert(value);
+  }
+  float cut=*next(reference.begin(),1200);
+
+  // The cut value goes right.
+  EXPECT_EQ(avl_split(&root,cut,&left,&right),AVL_SUCCESS);
+  EXPECT_EQ(root,nullptr);
+  EXPECT_EQ(get_size(left),1200);
+  EXPECT_EQ(get_size(right),static_cast<int>(reference.size())-1200);
+  ASSERT_GT(check_heights(left),0);
+  ASSERT_GT(check_heights(right),0);
+  ASSERT_EQ(check_sizes(left),1200);
+  ASSERT_TRUE(check_parents(left,nullptr) && check_parents(right,nullptr));
+  EXPECT_EQ(avl_min_get(right,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(found_node->value,cut);
+
+  // Join around a new value between the halves.
+  EXPECT_EQ(avl_node_remove(cut,&right),AVL_SUCCESS);
+  EXPECT_EQ(avl_join(left,cut,right,&root),AVL_SUCCESS);
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+  ASSERT_EQ(check_totals(root),static_cast<int>(reference.size()));
+  ASSERT_TRUE(check_parents(root,nullptr));
+  vector<float> values;
+  avl_range_scan(root,-1,7000,collect_values,&values);
+  EXPECT_TRUE(values.size()==reference.size() &&
+              equal(values.begin(),values.end(),reference.begin()));
+
+  // Cuts outside the values leave one side empty.
+  EXPECT_EQ(avl_split(&root,-5,&left,&right),AVL_SUCCESS);
+  EXPECT_EQ(left,nullptr);
+  EXPECT_EQ(avl_split(&right,9000,&left,&right),AVL_SUCCESS);
+  EXPECT_EQ(right,nullptr);
+  EXPECT_EQ(get_size(left),static_cast<int>(reference.size()));
+
+  // Very different heights.
+  struct avl_node *single=nullptr;
+  avl_node_add(-10,&single);
+  EXPECT_EQ(avl_join(single,-5,left,&root),AVL_SUCCESS);
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_TRUE(check_parents(root,nullptr));
+  EXPECT_EQ(get_size(root),static_cast<int>(reference.size())+2);
+
+  //Free memory
+  free_tree_mem(root);
+}
+
+// Values out of order around the middle value are rejected untouched.
+TEST(Split_join_test,negative){
+  struct avl_node *left=nullptr;
+  struct avl_node *right=nullptr;
+  struct avl_node *root=nullptr;
+  struct avl_node *empty=nullptr;
+
+  EXPECT_EQ(avl_split(&empty,1,&left,&right),AVL_SUCCESS);
+  EXPECT_EQ(left,nullptr);
+  EXPECT_EQ(right,nullptr);
+
+  avl_node_add(1,&left);
+  avl_node_add(2,&left);
+  avl_node_add(5,&right);
+  EXPECT_EQ(avl_join(left,2,right,&root),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_join(left,5,right,&root),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_join(left,nanf(""),right,&root),AVL_INVALID_PARAM);
+  EXPECT_EQ(root,nullptr);
+  EXPECT_EQ(get_size(left),2);
+  EXPECT_EQ(avl_join(left,3,right,&root),AVL_SUCCESS);
+  EXPECT_EQ(get_size(root),4);
+  free_tree_mem(root);
+
+  // The halves of a split are detached: cursors never cross the cut.
+  struct avl_node *found_node;
+  root=nullptr;
+  avl_node_add(1,&root);
+  avl_node_add(2,&root);
+  avl_node_add(3,&root);
+  EXPECT_EQ(avl_split(&root,2,&left,&right),AVL_SUCCESS);
+  ASSERT_NE(left,nullptr);
+  ASSERT_NE(right,nullptr);
+  EXPECT_EQ(left->parent,nullptr);
+  EXPECT_EQ(right->parent,nullptr);
+  ASSERT_TRUE(check_parents(left,nullptr) && check_parents(right,nullptr));
+  EXPECT_EQ(avl_next(left,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_prev(left,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_min_get(right,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(avl_prev(found_node,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_max_get(right,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(avl_next(found_node,&found_node),AVL_OUT_OF_RANGE);
+
+  //Free memory
+  free_tree_mem(left);
+  free_tree_mem(right);
+}
+
+// Erasing ranges agrees with std::set, freeing now, in the background or
+// into a pool.
+TEST(Erase_range_test,positive){
+  struct avl_node *root=nullptr;
+  set<float> reference;
+  int removed;
+
+  for (int index = 0; index < 10000; index++){
+    avl_node_add(static_cast<float>(index),&root);
+    reference.insert(static_cast<float>(index));
+  }
+
+  // Moving retention cutoff.
+  for (int cutoff = 500; cutoff <= 4000; cutoff+=500){
+    int free_mode=(cutoff%1000==0) ? AVL_FREE_BACKGROUND : AVL_FREE_NOW;
+    EXPECT_EQ(avl_erase_range(-1,static_cast<float>(cutoff),&root,free_mode,&removed),
+              AVL_SUCCESS);
+    EXPECT_EQ(removed,500);
+    reference.erase(reference.begin(),reference.lower_bound(static_cast<float>(cutoff)));
+    ASSERT_GT(check_heights(root),0);
+  }
+
+  // A range in the middle, and one that matches nothing.
+  EXPECT_EQ(avl_erase_range(6000.5f,7000,&root,AVL_FREE_BACKGROUND,&removed),AVL_SUCCESS);
+  EXPECT_EQ(removed,999);
+  reference.erase(reference.lower_bound(6000.5f),reference.lower_bound(7000));
+  EXPECT_EQ(avl_erase_range(20000,30000,&root,AVL_FREE_NOW,nullptr),AVL_SUCCESS);
+  avl_background_wait();
+
+  ASSERT_GT(check_heights(root),0);
+  ASSERT_EQ(check_sizes(root),static_cast<int>(reference.size()));
+  ASSERT_TRUE(check_parents(root,nullptr));
+  vector<float> values;
+  avl_range_scan(root,-1,20000,collect_values,&values);
+  EXPECT_TRUE(values.size()==reference.size() &&
+              equal(values.begin(),values.end(),reference.begin()));
+
+  // Everything at once empties the tree.
+  EXPECT_EQ(avl_erase_range(-1,20000,&root,AVL_FREE_NOW,&removed),AVL_SUCCESS);
+  EXPECT_EQ(removed,static_cast<int>(reference.size()));
+  EXPECT_EQ(root,nullptr);
+
+  // Pool nodes go back to the pool.
+  struct avl_pool pool;
+  avl_pool_init(&pool,64);
+  for (int index = 0; index < 300; index++){
+    avl_pool_node_add(static_cast<float>(index),&root,&pool);
+  }
+  EXPECT_EQ(avl_pool_erase_range(100,200,&root,&pool,&removed),AVL_SUCCESS);
+  EXPECT_EQ(removed,100);
+  EXPECT_EQ(pool.live_nodes,200);
+  ASSERT_GT(check_heights(root),0);
+  avl_pool_release(&pool);
+}
+
+// Empty trees, reversed ranges and unknown free modes are reported.
+TEST(Erase_range_test,negative){
+  struct avl_node *root=nullptr;
+  struct avl_pool pool;
+  avl_pool_init(&pool,64);
+
+  EXPECT_EQ(avl_erase_range(1,2,&root,AVL_FREE_NOW,nullptr),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_pool_erase_range(1,2,&root,&pool,nullptr),AVL_NOT_FOUND);
+  avl_node_add(1,&root);
+  EXPECT_EQ(avl_erase_range(2,1,&root,AVL_FREE_NOW,nullptr),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_pool_erase_range(2,1,&root,&pool,nullptr),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_erase_range(0,2,&root,7,nullptr),AVL_INVALID_PARAM);
+  EXPECT_EQ(get_size(root),1);
+
+  // Nothing queued, nothing to wait for.
+  avl_background_wait();
+
+  //Free memory
+  free_tree_mem(root);
+  avl_pool_release(&pool);
+}
+
+
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,122 @@
+#include "AVL_mapped.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <set>
+
+using namespace std;
+
+// Recomputes heights of a mapped tree and checks order and balance bits.
+// Returns the real height or -1 on mismatch.
+static int check_mapped(const struct avl_mapped_tree *tree, uint32_t index,
+                        uint32_t first, uint32_t last){
+    if (index==AVL_COMPACT_NIL){
+        return 0;
+    }
+    if (index<first || index>=last){
+        return -1;
+    }
+    const struct avl_compact_node &node=tree->nodes[index];
+    int left_height=check_mapped(tree,avl_compact_lc(node),first,index);
+    int right_height=check_mapped(tree,avl_compact_rc(node),index+1,last);
+    if (left_height<0 || right_height<0 ||
+        left_height-right_height!=avl_compact_balance(node)){
+        return -1;
+    }
+    return max(left_height,right_height)+1;
+}
+
+// A written tree maps back with the same values, order and shape.
+TEST(Mapped_test,positive){
+  const char *path="mapped_test.avl";
+  struct avl_node *root=nullptr;
+  struct avl_mapped_tree tree;
+  set<float> reference;
+  uint32_t found_index;
+
+  srand(19);
+  for (int index = 0; index < 5000; index++){
+    float value=static_cast<float>(rand()%20000)/4;
+    avl_node_add(value,&root);
+    reference.insert(value);
+  }
+  EXPECT_EQ(avl_mapped_write(root,path),AVL_SUCCESS);
+  free_tree_mem(root);
+
+  ASSERT_EQ(avl_mapped_open(path,&tree),AVL_SUCCESS);
+  EXPECT_EQ(tree.count,reference.size());
+  EXPECT_GE(check_mapped(&tree,tree.root,0,tree.count),0);
+  EXPECT_EQ(avl_mapped_verify(&tree),AVL_SUCCESS);
+
+  // Ordered iteration walks the array.
+  EXPECT_EQ(avl_mapped_min_get(&tree,&found_index),AVL_SUCCESS);
+  for (set<float>::iterator it = reference.begin(); it != reference.end(); ++it){
+    EXPECT_EQ(tree.nodes[found_index].value,*it);
+    uint32_t search_index;
+    EXPECT_EQ(avl_mapped_search(*it,&tree,&search_index),AVL_SUCCESS);
+    EXPECT_EQ(search_index,found_index);
+    avl_mapped_next(&tree,found_index,&found_index);
+  }
+  EXPECT_EQ(avl_mapped_max_get(&tree,&found_index),AVL_SUCCESS);
+  EXPECT_EQ(tree.nodes[found_index].value,*reference.rbegin());
+  EXPECT_EQ(avl_mapped_next(&tree,found_index,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_mapped_prev(&tree,found_index,&found_index),AVL_SUCCESS);
+
+  avl_mapped_close(&tree);
+  remove(path);
+}
+
+// Missing files, other formats, corrupt nodes and empty trees are reported.
+TEST(Mapped_test,negative){
+  const char *path="mapped_negative.avl";
+  struct avl_mapped_tree tree;
+  uint32_t found_index;
+
+  EXPECT_EQ(avl_mapped_open("missing_file.avl",&tree),AVL_NOT_FOUND);
+
+  // A file with a different version is rejected.
+  EXPECT_EQ(avl_mapped_write(nullptr,path),AVL_SUCCESS);
+  FILE *file=fopen(path,"r+b");
+  ASSERT_NE(file,nullptr);
+  uint32_t version=AVL_MAPPED_VERSION+1;
+  fseek(file,8,SEEK_SET);
+  fwrite(&version,sizeof(version),1,file);
+  fclose(file);
+  EXPECT_EQ(avl_mapped_open(path,&tree),AVL_INVALID_PARAM);
+
+  // Corrupt child indices: out of the file, and back to the root. Opening
+  // doesn't read nodes; searches through them and verify report it.
+  struct avl_node *root=nullptr;
+  for (int index = 0; index < 100; index++){
+    avl_node_add(static_cast<float>(index),&root);
+  }
+  uint32_t corrupt[]={100,AVL_COMPACT_NIL-1,0};
+  for (int index = 0; index < 3; index++){
+    EXPECT_EQ(avl_mapped_write(root,path),AVL_SUCCESS);
+    ASSERT_EQ(avl_mapped_open(path,&tree),AVL_SUCCESS);
+    uint32_t target=avl_compact_lc(tree.nodes[tree.root]);
+    uint32_t child=(index==2) ? tree.root : corrupt[index];
+    avl_mapped_close(&tree);
+    file=fopen(path,"r+b");
+    ASSERT_NE(file,nullptr);
+    fseek(file,sizeof(struct avl_mapped_header)+
+               target*sizeof(struct avl_compact_node)+sizeof(float),SEEK_SET);
+    fwrite(&child,sizeof(child),1,file);
+    fclose(file);
+    ASSERT_EQ(avl_mapped_open(path,&tree),AVL_SUCCESS);
+    EXPECT_EQ(avl_mapped_search(0,&tree,&found_index),AVL_INVALID_PARAM);
+    EXPECT_EQ(avl_mapped_verify(&tree),AVL_INVALID_PARAM);
+    avl_mapped_close(&tree);
+  }
+  free_tree_mem(root);
+
+  // An empty tree maps, but holds nothing.
+  EXPECT_EQ(avl_mapped_write(nullptr,path),AVL_SUCCESS);
+  ASSERT_EQ(avl_mapped_open(path,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_mapped_search(1,&tree,&found_index),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_mapped_verify(&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_mapped_min_get(&tree,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_mapped_max_get(&tree,&found_index),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_mapped_next(&tree,0,&found_index),AVL_INVALID_PARAM);
+  avl_mapped_close(&tree);
+  remove(path);
+}
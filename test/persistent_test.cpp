@@ -0,0 +1,143 @@
+#include "AVL_persistent.hpp"
+#include "gtest/gtest.h"
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Recomputes heights and sizes of a version, checks the AVL condition and
+// appends its values in order. Returns the real height or -1 on mismatch.
+static int check_version(const struct avl_pnode *node, vector<float> &values){
+    if (node==nullptr){
+        return 0;
+    }
+    int left_height=check_version(node->lc_node,values);
+    values.push_back(node->value);
+    int right_height=check_version(node->rc_node,values);
+    int balance=left_height-right_height;
+    if (left_height<0 || right_height<0 || balance>1 || balance<-1){
+        return -1;
+    }
+    int left_size=(node->lc_node==nullptr) ? 0 : node->lc_node->size;
+    int right_size=(node->rc_node==nullptr) ? 0 : node->rc_node->size;
+    int height=max(left_height,right_height)+1;
+    if (height!=node->height || left_size+right_size+1!=node->size){
+        return -1;
+    }
+    return height;
+}
+
+// Old snapshots keep their contents while the writer keeps changing the
+// tree, and every version stays balanced.
+TEST(Persistent_test,positive){
+  struct avl_persistent_tree tree;
+  vector<struct avl_snapshot> snapshots;
+  vector<set<float> > expected;
+  set<float> reference;
+  const struct avl_pnode *found_node=nullptr;
+
+  avl_persistent_init(&tree);
+  srand(13);
+  for (int index = 0; index < 3000; index++){
+    float value=static_cast<float>(rand()%500);
+    if (rand()%3==0){
+      int status=avl_persistent_remove(value,&tree);
+      EXPECT_EQ(status==AVL_SUCCESS,reference.erase(value)==1);
+    }
+    else {
+      EXPECT_EQ(avl_persistent_add(value,&tree),AVL_SUCCESS);
+      reference.insert(value);
+    }
+    if (index%250==0){
+      struct avl_snapshot snapshot;
+      avl_persistent_snapshot(&tree,&snapshot);
+      snapshots.push_back(snapshot);
+      expected.push_back(reference);
+    }
+  }
+
+  for (size_t index = 0; index < snapshots.size(); index++){
+    vector<float> values;
+    EXPECT_GE(check_version(snapshots[index].root,values),0);
+    EXPECT_EQ(avl_snapshot_size(&snapshots[index]),
+              static_cast<int>(expected[index].size()));
+    EXPECT_TRUE(equal(values.begin(),values.end(),expected[index].begin()));
+    EXPECT_EQ(avl_snapshot_min_get(&snapshots[index],&found_node),AVL_SUCCESS);
+    EXPECT_EQ(found_node->value,*expected[index].begin());
+    EXPECT_EQ(avl_snapshot_max_get(&snapshots[index],&found_node),AVL_SUCCESS);
+    EXPECT_EQ(found_node->value,*expected[index].rbegin());
+    avl_snapshot_release(&snapshots[index]);
+  }
+
+  // The current version matches the reference.
+  struct avl_snapshot current;
+  avl_persistent_snapshot(&tree,&current);
+  for (set<float>::iterator it = reference.begin(); it != reference.end(); ++it){
+    EXPECT_EQ(avl_snapshot_search(*it,&current,&found_node),AVL_SUCCESS);
+  }
+  avl_snapshot_release(&current);
+  avl_persistent_free(&tree);
+}
+
+// Readers walk their snapshots while the writer publishes new versions.
+TEST(Persistent_test,concurrent_readers){
+  struct avl_persistent_tree tree;
+
+  avl_persistent_init(&tree);
+  for (int value = 0; value < 1000; value++){
+    avl_persistent_add(static_cast<float>(value),&tree);
+  }
+
+  vector<thread> readers;
+  vector<int> failures(4,0);
+  for (int reader = 0; reader < 4; reader++){
+    readers.push_back(thread([&tree,&failures,reader](){
+      for (int round = 0; round < 200; round++){
+        struct avl_snapshot snapshot;
+        avl_persistent_snapshot(&tree,&snapshot);
+        vector<float> values;
+        if (check_version(snapshot.root,values)<0 ||
+            static_cast<int>(values.size())!=avl_snapshot_size(&snapshot)){
+          failures[reader]++;
+        }
+        avl_snapshot_release(&snapshot);
+      }
+    }));
+  }
+  for (int value = 0; value < 1000; value+=2){
+    avl_persistent_remove(static_cast<float>(value),&tree);
+    avl_persistent_add(static_cast<float>(value+1000),&tree);
+  }
+  for (size_t index = 0; index < readers.size(); index++){
+    readers[index].join();
+    EXPECT_EQ(failures[index],0);
+  }
+  avl_persistent_free(&tree);
+}
+
+// Empty versions and missing values report the same codes as the pointer tree.
+TEST(Persistent_test,negative){
+  struct avl_persistent_tree tree;
+  struct avl_snapshot snapshot;
+  const struct avl_pnode *found_node=nullptr;
+
+  avl_persistent_init(&tree);
+  EXPECT_EQ(avl_persistent_remove(1,&tree),AVL_NOT_FOUND);
+  avl_persistent_snapshot(&tree,&snapshot);
+  EXPECT_EQ(avl_snapshot_search(1,&snapshot,&found_node),AVL_NOT_FOUND);
+  EXPECT_EQ(avl_snapshot_min_get(&snapshot,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_snapshot_max_get(&snapshot,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_snapshot_size(&snapshot),0);
+
+  // Snapshots don't see later changes.
+  EXPECT_EQ(avl_persistent_add(1,&tree),AVL_SUCCESS);
+  EXPECT_EQ(avl_snapshot_search(1,&snapshot,&found_node),AVL_NOT_FOUND);
+  avl_snapshot_release(&snapshot);
+
+  EXPECT_EQ(avl_persistent_remove(2,&tree),AVL_OUT_OF_RANGE);
+  avl_persistent_snapshot(&tree,&snapshot);
+  EXPECT_EQ(avl_snapshot_search(0,&snapshot,&found_node),AVL_OUT_OF_RANGE);
+  avl_snapshot_release(&snapshot);
+  avl_persistent_free(&tree);
+}
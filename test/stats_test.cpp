@@ -0,0 +1,114 @@
+#include "AVL_stats.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+#ifdef AVL_STATS
+
+// Counters follow a known sequence of insertions, searches and removals.
+TEST(Stats_test,positive){
+  static struct avl_stats stats;
+  struct avl_stats_counters counters;
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node;
+
+  avl_stats_reset(&stats);
+  EXPECT_EQ(avl_stats_bind(&stats),nullptr);
+
+  // 3, 1, 2 needs one double rotation, 4 and 5 one single rotation and
+  // removing 1 another one.
+  float values[]={3,1,2,4,5};
+  for (int index = 0; index < 5; index++){
+    avl_node_add(values[index],&root);
+  }
+  EXPECT_EQ(avl_search(5,&root,&found_node),AVL_SUCCESS);
+  EXPECT_EQ(avl_search(7,&root,&found_node),AVL_OUT_OF_RANGE);
+  EXPECT_EQ(avl_node_remove(1,&root),AVL_SUCCESS);
+
+  ASSERT_EQ(avl_stats_snapshot(&stats,&counters),AVL_SUCCESS);
+  EXPECT_EQ(counters.operations[AVL_STATS_INSERT],5u);
+  EXPECT_EQ(counters.operations[AVL_STATS_SEARCH],2u);
+  EXPECT_EQ(counters.operations[AVL_STATS_REMOVE],1u);
+  EXPECT_EQ(counters.double_rotations[AVL_STATS_INSERT],1u);
+  EXPECT_EQ(counters.single_rotations[AVL_STATS_INSERT],1u);
+  EXPECT_EQ(counters.single_rotations[AVL_STATS_REMOVE],1u);
+  EXPECT_EQ(counters.double_rotations[AVL_STATS_REMOVE],0u);
+
+  // Searches ran on 2 (1, 4 (3, 5)): 5 is at depth 2, 7 falls off below it,
+  // and every node passed costs two comparisons.
+  EXPECT_EQ(counters.depths[AVL_STATS_SEARCH][2],1u);
+  EXPECT_EQ(counters.depths[AVL_STATS_SEARCH][3],1u);
+  EXPECT_EQ(counters.comparisons[AVL_STATS_SEARCH],12u);
+  uint64_t descents=0;
+  for (int depth = 0; depth < AVL_STATS_DEPTHS; depth++){
+    descents+=counters.depths[AVL_STATS_INSERT][depth];
+  }
+  EXPECT_EQ(descents,5u);
+
+  EXPECT_EQ(counters.allocations,5u);
+  EXPECT_EQ(counters.frees,1u);
+  EXPECT_EQ(counters.live_bytes,static_cast<int64_t>(4*sizeof(struct avl_node)));
+  free_tree_mem(root);
+  ASSERT_EQ(avl_stats_snapshot(&stats,&counters),AVL_SUCCESS);
+  EXPECT_EQ(counters.live_bytes,0);
+
+  // Pools give their nodes back as a whole.
+  struct avl_pool pool;
+  avl_pool_init(&pool,16);
+  root=nullptr;
+  for (int index = 0; index < 10; index++){
+    avl_pool_node_add(static_cast<float>(index),&root,&pool);
+  }
+  avl_pool_release(&pool);
+  ASSERT_EQ(avl_stats_snapshot(&stats,&counters),AVL_SUCCESS);
+  EXPECT_EQ(counters.allocations,15u);
+  EXPECT_EQ(counters.live_bytes,0);
+
+  // Repeated multiset values neither allocate nor rotate.
+  root=nullptr;
+  for (int index = 0; index < 8; index++){
+    avl_multi_add(static_cast<float>(index),&root);
+  }
+  avl_stats_reset(&stats);
+  for (int index = 0; index < 100; index++){
+    avl_multi_add(static_cast<float>(index%8),&root);
+  }
+  ASSERT_EQ(avl_stats_snapshot(&stats,&counters),AVL_SUCCESS);
+  EXPECT_EQ(counters.allocations,0u);
+  EXPECT_EQ(counters.single_rotations[AVL_STATS_INSERT]+
+            counters.double_rotations[AVL_STATS_INSERT],0u);
+  free_tree_mem(root);
+
+  EXPECT_EQ(avl_stats_bind(nullptr),&stats);
+}
+
+// Unbound threads record nothing and bad arguments are reported.
+TEST(Stats_test,negative){
+  static struct avl_stats stats;
+  struct avl_stats_counters counters;
+  struct avl_node *root=nullptr;
+
+  avl_stats_reset(&stats);
+  avl_node_add(1,&root);
+  free_tree_mem(root);
+  ASSERT_EQ(avl_stats_snapshot(&stats,&counters),AVL_SUCCESS);
+  EXPECT_EQ(counters.operations[AVL_STATS_INSERT],0u);
+  EXPECT_EQ(counters.allocations,0u);
+  EXPECT_EQ(avl_stats_snapshot(nullptr,&counters),AVL_INVALID_PARAM);
+  EXPECT_EQ(avl_stats_snapshot(&stats,nullptr),AVL_INVALID_PARAM);
+}
+
+#else
+
+// Without AVL_STATS there are no counters to report.
+TEST(Stats_test,negative){
+  static struct avl_stats stats;
+  struct avl_stats_counters counters;
+
+  avl_stats_reset(&stats);
+  EXPECT_EQ(avl_stats_bind(&stats),nullptr);
+  EXPECT_EQ(avl_stats_bind(nullptr),nullptr);
+  EXPECT_EQ(avl_stats_snapshot(&stats,&counters),AVL_NOT_FOUND);
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include "AVL_trace.hpp"
+#include "gtest/gtest.h"
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Reads a whole file into a string.
+static string read_trace(const char *path){
+    ifstream file(path);
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// Counts the spans with the given name in a written trace.
+static int count_spans(const string &trace, const string &name){
+    int count=0;
+    string pattern="\"name\":\""+name+"\"";
+    for (size_t found = trace.find(pattern); found != string::npos;
+         found = trace.find(pattern,found+1)){
+      count++;
+    }
+    return count;
+}
+
+#ifdef AVL_TRACE
+
+// Spans of every traced operation reach the file, one track per thread.
+TEST(Trace_test,positive){
+  const char *path="trace_test.json";
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node;
+
+  ASSERT_EQ(avl_trace_start(),AVL_SUCCESS);
+  for (int index = 0; index < 8; index++){
+    avl_node_add(static_cast<float>(index),&root);
+  }
+  avl_search(3,&root,&found_node);
+  avl_node_remove(3,&root);
+  free_tree_mem(root);
+
+  thread worker([](){
+    struct avl_node *other_root=nullptr;
+    float values[]={1,2,3};
+    avl_create(values,3,&other_root);
+    free_tree_mem(other_root);
+  });
+  worker.join();
+  avl_trace_stop();
+
+  // Stopped: nothing else is recorded.
+  root=nullptr;
+  avl_node_add(1,&root);
+  free_tree_mem(root);
+
+  ASSERT_EQ(avl_trace_dump(path),AVL_SUCCESS);
+  string trace=read_trace(path);
+  EXPECT_EQ(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["),0u);
+  EXPECT_EQ(count_spans(trace,"avl_node_add"),11);
+  EXPECT_EQ(count_spans(trace,"avl_search"),1);
+  EXPECT_EQ(count_spans(trace,"avl_node_remove"),1);
+  EXPECT_EQ(count_spans(trace,"avl_create"),1);
+  EXPECT_EQ(count_spans(trace,"free_tree_mem"),2);
+  EXPECT_GT(count_spans(trace,"rotate_left"),0);
+  EXPECT_NE(trace.find("\"ph\":\"X\""),string::npos);
+
+  // The worker has a track of its own.
+  set<string> tids;
+  for (size_t found = trace.find("\"tid\":"); found != string::npos;
+       found = trace.find("\"tid\":",found+1)){
+    tids.insert(trace.substr(found,trace.find(',',found)-found));
+  }
+  EXPECT_EQ(tids.size(),2u);
+
+  // A new start leaves the older spans out.
+  ASSERT_EQ(avl_trace_start(),AVL_SUCCESS);
+  avl_trace_stop();
+  ASSERT_EQ(avl_trace_dump(path),AVL_SUCCESS);
+  EXPECT_EQ(count_spans(read_trace(path),"avl_node_add"),0);
+  remove(path);
+}
+
+// Full rings keep the newest spans and bad paths are reported.
+TEST(Trace_test,negative){
+  const char *path="trace_negative.json";
+  struct avl_node *root=nullptr;
+  struct avl_node *found_node;
+
+  EXPECT_EQ(avl_trace_dump("missing_dir/trace.json"),AVL_NOT_FOUND);
+
+  avl_node_add(1,&root);
+  ASSERT_EQ(avl_trace_start(),AVL_SUCCESS);
+  for (int index = 0; index < AVL_TRACE_CAPACITY+100; index++){
+    avl_search(1,&root,&found_node);
+  }
+  avl_trace_stop();
+  free_tree_mem(root);
+  ASSERT_EQ(avl_trace_dump(path),AVL_SUCCESS);
+  EXPECT_EQ(count_spans(read_trace(path),"avl_search"),AVL_TRACE_CAPACITY-1);
+  remove(path);
+}
+
+// Buffers of finished threads go to new threads once their spans are
+// written, and not before.
+TEST(Trace_reuse_test,positive){
+  const char *path="trace_reuse.json";
+  struct avl_detail::trace_buffer *buffers[3];
+  auto traced=[](struct avl_detail::trace_buffer **buffer){
+    struct avl_node *other_root=nullptr;
+    avl_node_add(1,&other_root);
+    free_tree_mem(other_root);
+    *buffer=avl_detail::trace_local;
+  };
+
+  ASSERT_EQ(avl_trace_start(),AVL_SUCCESS);
+  thread first(traced,&buffers[0]);
+  first.join();
+
+  // Spans not written yet, the buffer is kept.
+  thread second(traced,&buffers[1]);
+  second.join();
+  EXPECT_NE(buffers[1],buffers[0]);
+
+  ASSERT_EQ(avl_trace_dump(path),AVL_SUCCESS);
+  EXPECT_EQ(count_spans(read_trace(path),"avl_node_add"),2);
+  thread third(traced,&buffers[2]);
+  third.join();
+  EXPECT_TRUE(buffers[2]==buffers[0] || buffers[2]==buffers[1]);
+  avl_trace_stop();
+
+  // The reused buffer starts empty: the span it held is not written again.
+  ASSERT_EQ(avl_trace_dump(path),AVL_SUCCESS);
+  EXPECT_EQ(count_spans(read_trace(path),"avl_node_add"),2);
+  remove(path);
+}
+
+#else
+
+// Without AVL_TRACE there is nothing to record or write.
+TEST(Trace_test,negative){
+  EXPECT_EQ(avl_trace_start(),AVL_NOT_FOUND);
+  avl_trace_stop();
+  EXPECT_EQ(avl_trace_dump("trace_negative.json"),AVL_NOT_FOUND);
+  EXPECT_EQ(count_spans(read_trace("missing_file.json"),"avl_search"),0);
+}
+
+#endif